@@ -0,0 +1,381 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// the lookup cost of the ctmap storages against the standard containers and a switch:
+//   ctmap-compare [filter]
+// every benchmark is named `<container>/<key>/<size>/<hits>/<distribution>`, the optional
+// argument runs only the benchmarks which names contain it.
+
+#include "do_not_optimize.hpp"
+#include "perf_counters.hpp"
+
+#include <ctmap/ctmap.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*************************************************************************************************/
+
+using value_type = std::uint32_t;
+
+static constexpr std::size_t num_queries = 1u << 16;
+static constexpr std::size_t num_lookups = 1u << 21;
+static constexpr std::size_t max_size = 100000;
+
+// sparse, unique keys: an odd multiplier is a bijection modulo 2^N
+template<typename K>
+constexpr K int_key(std::size_t i) noexcept {
+    if constexpr ( sizeof(K) == 4 ) {
+        return static_cast<K>(i * 2654435761u);
+    } else {
+        return static_cast<K>(i * 0x9e3779b97f4a7c15ull);
+    }
+}
+
+// a miss is the key with the high bit flipped, that is `int_key(i + 2^(N-1))`, never a hit
+template<typename K>
+constexpr K int_miss(K k) noexcept { return k ^ (K{1} << (sizeof(K) * 8 - 1)); }
+
+// the names of 3..12 pseudo random lowercase chars followed by the index, so they are unique.
+// the misses have the last char replaced with the `_` which is not used in the names.
+static std::vector<std::string> make_names() {
+    std::vector<std::string> names(max_size);
+    ctmap::details::splitmix64 rnd{max_size};
+    for ( std::size_t i = 0; i < max_size; ++i ) {
+        const std::size_t len = 3 + rnd() % 10;
+        for ( std::size_t j = 0; j < len; ++j ) {
+            names[i] += static_cast<char>('a' + rnd() % 26);
+        }
+        names[i] += std::to_string(i);
+    }
+
+    return names;
+}
+
+static const std::vector<std::string> names = make_names();
+static std::vector<std::string> missed_names;
+
+template<typename K>
+struct key_traits;
+
+template<>
+struct key_traits<std::uint32_t> {
+    static constexpr const char *name = "u32";
+    static std::uint32_t key(std::size_t i) { return int_key<std::uint32_t>(i); }
+    static std::uint32_t miss(std::size_t i) { return int_miss(key(i)); }
+};
+
+template<>
+struct key_traits<std::uint64_t> {
+    static constexpr const char *name = "u64";
+    static std::uint64_t key(std::size_t i) { return int_key<std::uint64_t>(i); }
+    static std::uint64_t miss(std::size_t i) { return int_miss(key(i)); }
+};
+
+template<>
+struct key_traits<std::string_view> {
+    static constexpr const char *name = "string_view";
+    static std::string_view key(std::size_t i) { return names[i]; }
+    static std::string_view miss(std::size_t i) {
+        if ( missed_names.empty() ) {
+            missed_names = names;
+            for ( auto &it: missed_names ) {
+                it.back() = '_';
+            }
+        }
+        return missed_names[i];
+    }
+};
+
+/*************************************************************************************************/
+
+enum class distribution { uniform, zipf };
+
+// the indices of the keys drawn with the Zipf's law, s=1: the key of the rank `r` is queried
+// with the probability proportional to 1/r. the ranks are shuffled over the keys, so the hot
+// keys are spread over the table.
+struct zipf_sampler {
+    zipf_sampler(std::size_t n, ctmap::details::splitmix64 &rnd)
+        :m_cdf(n)
+        ,m_perm(n)
+    {
+        double sum = 0;
+        for ( std::size_t r = 0; r < n; ++r ) {
+            sum += 1.0 / static_cast<double>(r + 1);
+            m_cdf[r] = sum;
+            m_perm[r] = r;
+        }
+        for ( auto &it: m_cdf ) {
+            it /= sum;
+        }
+        for ( std::size_t i = n; i > 1; --i ) {
+            std::swap(m_perm[i - 1], m_perm[rnd() % i]);
+        }
+    }
+
+    std::size_t operator()(ctmap::details::splitmix64 &rnd) const {
+        const double u = static_cast<double>(rnd() >> 11) * (1.0 / 9007199254740992.0);
+        const auto it = std::lower_bound(m_cdf.begin(), m_cdf.end(), u);
+        const auto r = std::min<std::size_t>(static_cast<std::size_t>(it - m_cdf.begin()), m_cdf.size() - 1);
+
+        return m_perm[r];
+    }
+
+private:
+    std::vector<double> m_cdf;
+    std::vector<std::size_t> m_perm;
+};
+
+template<typename K>
+std::vector<K> make_queries(std::size_t n, unsigned hit_percent, distribution dist) {
+    ctmap::details::splitmix64 rnd{n * 100 + hit_percent};
+    const zipf_sampler zipf{dist == distribution::zipf ? n : 1, rnd};
+
+    std::vector<K> queries(num_queries);
+    for ( auto &it: queries ) {
+        const std::size_t i = (dist == distribution::zipf) ? zipf(rnd) : rnd() % n;
+        it = (rnd() % 100 < hit_percent) ? key_traits<K>::key(i) : key_traits<K>::miss(i);
+    }
+
+    return queries;
+}
+
+/*************************************************************************************************/
+
+struct options {
+    const char *filter = nullptr;
+    perf_counters counters;
+};
+
+template<typename K, typename F>
+void run(options &opts, const char *container, std::size_t n, unsigned hit_percent, distribution dist, F &&f) {
+    char name[128];
+    std::snprintf(name, sizeof(name), "%s/%s/%zu/hit%u/%s"
+        ,container
+        ,key_traits<K>::name
+        ,n
+        ,hit_percent
+        ,(dist == distribution::zipf ? "zipf" : "uniform")
+    );
+    if ( opts.filter && !std::strstr(name, opts.filter) ) {
+        return;
+    }
+
+    const auto queries = make_queries<K>(n, hit_percent, dist);
+    std::size_t sink = 0;
+    for ( const auto &q: queries ) {
+        sink += f(q);
+    }
+
+    const std::size_t rounds = num_lookups / queries.size();
+    opts.counters.start();
+    const auto start = std::chrono::steady_clock::now();
+    for ( std::size_t r = 0; r < rounds; ++r ) {
+        for ( const auto &q: queries ) {
+            sink += f(q);
+        }
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    opts.counters.stop();
+    do_not_optimize(sink);
+
+    const double lookups = static_cast<double>(rounds * queries.size());
+    const double ns = std::chrono::duration<double, std::nano>(stop - start).count() / lookups;
+    if ( opts.counters.available() ) {
+        std::printf("%-52s %10.2f %12.3f %12.3f\n"
+            ,name
+            ,ns
+            ,static_cast<double>(opts.counters.value(perf_counters::branch_misses)) / lookups
+            ,static_cast<double>(opts.counters.value(perf_counters::cache_misses)) / lookups
+        );
+    } else {
+        std::printf("%-52s %10.2f %12s %12s\n", name, ns, "-", "-");
+    }
+}
+
+/*************************************************************************************************/
+
+// the plain switches over the keys of the tables, the independent baseline. the case labels
+// can't be generated from a pack, so the preprocessor is expanding them.
+#define CTMAP_CASE(i) case int_key<K>(i): return static_cast<value_type>(i);
+#define CTMAP_CASES_4(b) \
+    CTMAP_CASE(b) CTMAP_CASE((b)+1) CTMAP_CASE((b)+2) CTMAP_CASE((b)+3)
+#define CTMAP_CASES_16(b) \
+    CTMAP_CASES_4(b) CTMAP_CASES_4((b)+4) CTMAP_CASES_4((b)+8) CTMAP_CASES_4((b)+12)
+#define CTMAP_CASES_64(b) \
+    CTMAP_CASES_16(b) CTMAP_CASES_16((b)+16) CTMAP_CASES_16((b)+32) CTMAP_CASES_16((b)+48)
+#define CTMAP_CASES_256(b) \
+    CTMAP_CASES_64(b) CTMAP_CASES_64((b)+64) CTMAP_CASES_64((b)+128) CTMAP_CASES_64((b)+192)
+#define CTMAP_CASES_1024(b) \
+    CTMAP_CASES_256(b) CTMAP_CASES_256((b)+256) CTMAP_CASES_256((b)+512) CTMAP_CASES_256((b)+768)
+
+template<typename K, std::size_t N>
+value_type switch_n(K k) noexcept {
+    if constexpr ( N == 4 ) {
+        switch ( k ) { CTMAP_CASES_4(0) default: return value_type{}; }
+    } else if constexpr ( N == 16 ) {
+        switch ( k ) { CTMAP_CASES_16(0) default: return value_type{}; }
+    } else if constexpr ( N == 64 ) {
+        switch ( k ) { CTMAP_CASES_64(0) default: return value_type{}; }
+    } else if constexpr ( N == 256 ) {
+        switch ( k ) { CTMAP_CASES_256(0) default: return value_type{}; }
+    } else {
+        static_assert(N == 1024, "there is no switch of this size");
+        switch ( k ) { CTMAP_CASES_1024(0) default: return value_type{}; }
+    }
+}
+
+#undef CTMAP_CASES_1024
+#undef CTMAP_CASES_256
+#undef CTMAP_CASES_64
+#undef CTMAP_CASES_16
+#undef CTMAP_CASES_4
+#undef CTMAP_CASE
+
+// the compile-time dispatch over the same keys: the jump table for the dense keys, and the storage
+// search followed by the indirect call for the sparse ones.
+template<typename K, std::size_t ...Is>
+constexpr auto make_switch_map(std::index_sequence<Is...>) {
+    using cmp = ctmap::details::less_key<std::pair<K, value_type>>;
+    return ctmap::make_map_cmp(cmp{}, std::make_pair(int_key<K>(Is), static_cast<value_type>(Is))...);
+}
+
+template<typename K, std::size_t N>
+struct switch_table {
+    static constexpr auto map = make_switch_map<K>(std::make_index_sequence<N>{});
+
+    static value_type find(K k) noexcept {
+        return ctmap::dispatch<map>(k, [](value_type v) { return v; }, [](K) { return value_type{}; });
+    }
+};
+
+// the sizes of the switch and the dispatch are limited by the compile time
+static constexpr std::size_t max_switch_size = 1024;
+
+template<typename K, std::size_t N>
+void bench_switch(options &opts, unsigned hit_percent, distribution dist) {
+    if constexpr ( std::is_integral<K>::value && N <= max_switch_size ) {
+        run<K>(opts, "switch", N, hit_percent, dist, [](K k) { return switch_n<K, N>(k); });
+        run<K>(opts, "ctmap::dispatch", N, hit_percent, dist, [](K k) { return switch_table<K, N>::find(k); });
+    }
+}
+
+template<typename Map, typename K>
+value_type find_or_zero(const Map &m, const K &k) noexcept {
+    const auto r = m.find(k);
+    return r.first ? r.second : value_type{};
+}
+
+template<typename K, std::size_t N>
+void bench_size(options &opts) {
+    using pair_type = std::pair<K, value_type>;
+    using cmp = ctmap::details::less_key<pair_type>;
+
+    // the big tables are too heavy for a compile time build, all of them are built at runtime
+    auto data = std::make_unique<std::array<pair_type, N>>();
+    for ( std::size_t i = 0; i < N; ++i ) {
+        (*data)[i] = {key_traits<K>::key(i), static_cast<value_type>(i)};
+    }
+    const auto sorted = std::make_unique<const ctmap::map<N, K, value_type, cmp>>(*data);
+    const auto unordered = std::make_unique<const ctmap::unordered_map<N, K, value_type>>(*data);
+    const auto eytzinger = std::make_unique<const ctmap::eytzinger_map<N, K, value_type>>(*data);
+
+    const std::map<K, value_type> std_map(data->begin(), data->end());
+    const std::unordered_map<K, value_type> std_unordered(data->begin(), data->end());
+    std::vector<pair_type> vec(data->begin(), data->end());
+    std::sort(vec.begin(), vec.end());
+
+    for ( unsigned hit_percent: {100u, 50u} ) {
+        for ( distribution dist: {distribution::uniform, distribution::zipf} ) {
+            run<K>(opts, "ctmap::map", N, hit_percent, dist
+                ,[&m = *sorted](const K &k) { return find_or_zero(m, k); });
+            run<K>(opts, "ctmap::unordered_map", N, hit_percent, dist
+                ,[&m = *unordered](const K &k) { return find_or_zero(m, k); });
+            run<K>(opts, "ctmap::eytzinger_map", N, hit_percent, dist
+                ,[&m = *eytzinger](const K &k) { return find_or_zero(m, k); });
+            run<K>(opts, "std::map", N, hit_percent, dist
+                ,[&std_map](const K &k) {
+                    const auto it = std_map.find(k);
+                    return it != std_map.end() ? it->second : value_type{};
+                }
+            );
+            run<K>(opts, "std::unordered_map", N, hit_percent, dist
+                ,[&std_unordered](const K &k) {
+                    const auto it = std_unordered.find(k);
+                    return it != std_unordered.end() ? it->second : value_type{};
+                }
+            );
+            run<K>(opts, "std::lower_bound", N, hit_percent, dist
+                ,[&vec](const K &k) {
+                    const auto it = std::lower_bound(vec.begin(), vec.end(), k
+                        ,[](const pair_type &l, const K &r) { return l.first < r; }
+                    );
+                    return (it != vec.end() && it->first == k) ? it->second : value_type{};
+                }
+            );
+            bench_switch<K, N>(opts, hit_percent, dist);
+        }
+    }
+}
+
+template<typename K>
+void bench_key(options &opts) {
+    bench_size<K, 4>(opts);
+    bench_size<K, 16>(opts);
+    bench_size<K, 64>(opts);
+    bench_size<K, 256>(opts);
+    bench_size<K, 1024>(opts);
+    bench_size<K, 10000>(opts);
+    bench_size<K, max_size>(opts);
+}
+
+/*************************************************************************************************/
+
+int main(int argc, char **argv) {
+    options opts;
+    opts.filter = (argc > 1) ? argv[1] : nullptr;
+
+    std::printf("%-52s %10s %12s %12s\n", "benchmark", "ns/lookup", "br-miss/op", "cache-miss/op");
+    if ( !opts.counters.available() ) {
+        std::printf("# the perf counters are not available\n");
+    }
+
+    bench_key<std::uint32_t>(opts);
+    bench_key<std::uint64_t>(opts);
+    bench_key<std::string_view>(opts);
+
+    return 0;
+}
+
+/*************************************************************************************************/
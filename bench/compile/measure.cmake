@@ -0,0 +1,66 @@
+# measures the constexpr build cost of bench/compile/table.cpp.
+#
+# usage:
+#   cmake -DCXX=<compiler> -DMEASURE=<ctmap-measure> -DSOURCE=<table.cpp>
+#         -DINCLUDE_DIR=<dir> -DSTEPS_FLAG=<-fconstexpr-ops-limit=|-fconstexpr-steps=>
+#         -DSIZES="100;1000" -DWORK_DIR=<dir> -P measure.cmake
+#
+# for every size the table is compiled once with an unbounded step limit to get
+# the build time and peak memory, then the step limit is doubled starting from
+# 2^16 until the build passes, which gives an upper bound of the constexpr steps
+# used (within a factor of two).
+
+foreach(var CXX MEASURE SOURCE INCLUDE_DIR SIZES WORK_DIR)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "measure.cmake: ${var} is not set")
+    endif()
+endforeach()
+
+set(OUT "${WORK_DIR}/table.o")
+set(MAX_STEPS 4294967296)
+
+function(compile_table n steps res_var out_var)
+    set(args -std=c++17 -I${INCLUDE_DIR} -DCTMAP_BENCH_N=${n})
+    if(STEPS_FLAG)
+        list(APPEND args ${STEPS_FLAG}${steps})
+    endif()
+    execute_process(
+        COMMAND ${MEASURE} ${CXX} ${args} -c ${SOURCE} -o ${OUT}
+        RESULT_VARIABLE res
+        OUTPUT_VARIABLE out
+        ERROR_QUIET
+    )
+    set(${res_var} ${res} PARENT_SCOPE)
+    set(${out_var} ${out} PARENT_SCOPE)
+endfunction()
+
+set(report "")
+foreach(n ${SIZES})
+    compile_table(${n} ${MAX_STEPS} res out)
+    if(NOT res EQUAL 0)
+        message(FATAL_ERROR "measure.cmake: N=${n} does not compile")
+    endif()
+    string(REGEX MATCH "time_ms=([0-9]+)" _ "${out}")
+    set(time_ms ${CMAKE_MATCH_1})
+    string(REGEX MATCH "maxrss_kb=([0-9]+)" _ "${out}")
+    set(rss_kb ${CMAKE_MATCH_1})
+
+    set(steps "n/a")
+    if(STEPS_FLAG)
+        set(steps 65536)
+        while(steps LESS MAX_STEPS)
+            compile_table(${n} ${steps} res out)
+            if(res EQUAL 0)
+                break()
+            endif()
+            math(EXPR steps "${steps} * 2")
+        endwhile()
+        set(steps "<=${steps}")
+    endif()
+
+    message(STATUS "N=${n}: time=${time_ms}ms maxrss=${rss_kb}KB constexpr-steps${steps}")
+    string(APPEND report "${n}\t${time_ms}\t${rss_kb}\t${steps}\n")
+endforeach()
+
+file(WRITE "${WORK_DIR}/compile-bench.tsv" "N\ttime_ms\tmaxrss_kb\tconstexpr_steps\n${report}")
+message(STATUS "results written to ${WORK_DIR}/compile-bench.tsv")
@@ -0,0 +1,82 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// runs a command and reports its wall time, CPU time (user + system), peak RSS and exit code:
+//   ctmap-measure <cmd> [args...]
+// output: "time_ms=<ms> cpu_ms=<ms> maxrss_kb=<kb> status=<code>"
+
+#include <chrono>
+#include <cstdio>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*************************************************************************************************/
+
+int main(int argc, char **argv) {
+    if ( argc < 2 ) {
+        std::fprintf(stderr, "usage: %s <cmd> [args...]\n", argv[0]);
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = ::fork();
+    if ( pid < 0 ) {
+        std::perror("fork");
+        return 2;
+    }
+    if ( pid == 0 ) {
+        ::execvp(argv[1], argv + 1);
+        std::perror("execvp");
+        ::_exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage{};
+    if ( ::wait4(pid, &status, 0, &usage) < 0 ) {
+        std::perror("wait4");
+        return 2;
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+
+    const long long cpu_ms =
+         (static_cast<long long>(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1000
+        +(static_cast<long long>(usage.ru_utime.tv_usec) + usage.ru_stime.tv_usec) / 1000
+    ;
+
+    int code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    std::printf("time_ms=%lld cpu_ms=%lld maxrss_kb=%ld status=%d\n"
+        ,static_cast<long long>(ms)
+        ,cpu_ms
+        ,static_cast<long>(usage.ru_maxrss)
+        ,code
+    );
+
+    return code;
+}
@@ -0,0 +1,77 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// compile-time workload for the `compile-bench` target.
+// builds a map of CTMAP_BENCH_N pseudo-random keys entirely in a constant expression.
+
+#include <ctmap/ctmap.hpp>
+
+#include <cstdint>
+
+#ifndef CTMAP_BENCH_N
+#   define CTMAP_BENCH_N 100
+#endif
+
+/*************************************************************************************************/
+
+static constexpr std::size_t N = CTMAP_BENCH_N;
+static_assert(N <= 0x10000, "keys are only unique up to 64k entries");
+
+using data_type = std::array<std::pair<std::uint32_t, std::uint32_t>, N>;
+
+constexpr data_type make_data() {
+    data_type res{};
+    ctmap::details::splitmix64 rnd{N};
+    for ( std::size_t i = 0; i < N; ++i ) {
+        // the low bits are the index, so the keys are unique
+        auto hi = static_cast<std::uint32_t>(rnd()) & ~std::uint32_t{0xffff};
+        res[i].first  = hi | static_cast<std::uint32_t>(i & 0xffff);
+        res[i].second = static_cast<std::uint32_t>(i);
+    }
+
+    return res;
+}
+
+template<typename Map>
+constexpr bool is_sorted(const Map &m) {
+    for ( std::size_t i = 1; i < m.size(); ++i ) {
+        if ( m[i].first < m[i - 1].first ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static constexpr ctmap::map<N, std::uint32_t, std::uint32_t> map{make_data()};
+
+static_assert(map.size() == N);
+static_assert(is_sorted(map));
+
+/*************************************************************************************************/
+
+int main() {
+    return map.find(map.begin()->first).first ? 0 : 1;
+}
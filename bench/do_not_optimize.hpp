@@ -0,0 +1,46 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------
+
+#ifndef __CTMAP__BENCH__DO_NOT_OPTIMIZE_HPP
+#define __CTMAP__BENCH__DO_NOT_OPTIMIZE_HPP
+
+/*************************************************************************************************/
+
+// makes the compiler assume that `v` is used, so the computation of it is not removed
+template<typename T>
+inline void do_not_optimize(const T &v) noexcept {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(v) : "memory");
+#else
+    static volatile T sink;
+    sink = v;
+    static_cast<void>(sink);
+#endif
+}
+
+/*************************************************************************************************/
+
+#endif // __CTMAP__BENCH__DO_NOT_OPTIMIZE_HPP
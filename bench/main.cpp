@@ -0,0 +1,371 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "do_not_optimize.hpp"
+
+#include <ctmap/ctmap.hpp>
+#include <ctmap/frozen_map.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*************************************************************************************************/
+
+// a command-names-like vocabulary: pseudo random lowercase names of 3..12 chars.
+template<std::size_t N>
+struct names_t {
+    char data[N][16]{};
+    std::size_t size[N]{};
+
+    constexpr names_t() {
+        ctmap::details::splitmix64 rnd{N};
+        for ( std::size_t i = 0; i < N; ++i ) {
+            size[i] = 3 + rnd() % 10;
+            for ( std::size_t j = 0; j < size[i]; ++j ) {
+                data[i][j] = static_cast<char>('a' + rnd() % 26);
+            }
+        }
+    }
+
+    constexpr std::string_view operator[](std::size_t i) const noexcept
+    { return {data[i], size[i]}; }
+};
+
+static constexpr std::size_t num_names = 300;
+static constexpr names_t<num_names> names{};
+
+template<std::size_t ...Is>
+constexpr auto make_sorted(std::index_sequence<Is...>) {
+    return ctmap::make_map(std::make_pair(names[Is], Is)...);
+}
+
+template<std::size_t ...Is>
+constexpr auto make_unordered(std::index_sequence<Is...>) {
+    return ctmap::make_unordered_map(std::make_pair(names[Is], Is)...);
+}
+
+template<std::size_t ...Is>
+constexpr auto make_string(std::index_sequence<Is...>) {
+    return ctmap::make_string_map(std::make_pair(names[Is], Is)...);
+}
+
+template<std::size_t ...Is>
+constexpr auto make_trie(std::index_sequence<Is...>) {
+    return ctmap::make_trie_map(std::make_pair(names[Is], Is)...);
+}
+
+static constexpr auto sorted_map = make_sorted(std::make_index_sequence<num_names>{});
+static constexpr auto string_map = make_string(std::make_index_sequence<num_names>{});
+static constexpr auto trie_map = make_trie(std::make_index_sequence<num_names>{});
+static constexpr auto unordered_map = make_unordered(std::make_index_sequence<num_names>{});
+
+/*************************************************************************************************/
+
+static constexpr std::size_t num_ints = 4096;
+
+// sparse, unique keys: an odd multiplier is a bijection modulo 2^32
+constexpr std::uint32_t int_key(std::size_t i) noexcept
+{ return static_cast<std::uint32_t>(i * 2654435761u); }
+
+// make_map() would pick the dense_storage for the integral keys
+using int_cmp = ctmap::details::less_key<std::pair<std::uint32_t, std::size_t>>;
+
+template<std::size_t ...Is>
+constexpr auto make_int_sorted(std::index_sequence<Is...>) {
+    return ctmap::make_map_cmp(int_cmp{}, std::make_pair(int_key(Is), Is)...);
+}
+
+template<std::size_t ...Is>
+constexpr auto make_int_eytzinger(std::index_sequence<Is...>) {
+    return ctmap::make_eytzinger_map(std::make_pair(int_key(Is), Is)...);
+}
+
+template<std::size_t ...Is>
+constexpr auto make_int_soa(std::index_sequence<Is...>) {
+    return ctmap::make_soa_map(std::make_pair(int_key(Is), Is)...);
+}
+
+template<std::size_t ...Is>
+constexpr auto make_int_dense(std::index_sequence<Is...>) {
+    // every third key is missing
+    return ctmap::make_map(std::make_pair(static_cast<std::uint32_t>(Is + Is / 2), Is)...);
+}
+
+template<std::size_t ...Is>
+constexpr auto make_int_dense_sorted(std::index_sequence<Is...>) {
+    return ctmap::make_map_cmp(int_cmp{}, std::make_pair(static_cast<std::uint32_t>(Is + Is / 2), Is)...);
+}
+
+// two hot keys are taking 90% of the lookups
+template<std::size_t ...Is>
+constexpr auto make_int_weighted(std::index_sequence<Is...>) {
+    return ctmap::make_weighted_map(
+         std::array<std::pair<std::uint32_t, std::size_t>, sizeof...(Is)>{{std::make_pair(int_key(Is), Is)...}}
+        ,std::array<std::uint64_t, sizeof...(Is)>{{(Is == 0 ? 700u : Is == 1 ? 200u : 2u)...}}
+    );
+}
+
+static const auto int_sorted_map = make_int_sorted(std::make_index_sequence<num_ints>{});
+static const auto dense_map = make_int_dense(std::make_index_sequence<num_ints>{});
+static const auto dense_sorted_map = make_int_dense_sorted(std::make_index_sequence<num_ints>{});
+static const auto small_sorted_map = make_int_sorted(std::make_index_sequence<48>{});
+static const auto small_soa_map = make_int_soa(std::make_index_sequence<48>{});
+static const auto small_weighted_map = make_int_weighted(std::make_index_sequence<48>{});
+static const auto int_soa_map = make_int_soa(std::make_index_sequence<num_ints>{});
+static const auto int_eytzinger_map = make_int_eytzinger(std::make_index_sequence<num_ints>{});
+
+/*************************************************************************************************/
+
+template<typename Q, typename F>
+double measure(const std::vector<Q> &queries, std::size_t rounds, F &&f) {
+    std::size_t sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for ( std::size_t r = 0; r < rounds; ++r ) {
+        for ( const auto &q: queries ) {
+            sink += f(q);
+        }
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    do_not_optimize(sink);
+
+    return std::chrono::duration<double, std::nano>(stop - start).count()
+        / static_cast<double>(rounds * queries.size());
+}
+
+/*************************************************************************************************/
+
+using batch_cmp = ctmap::details::less_key<std::pair<std::uint32_t, std::uint32_t>>;
+
+template<typename F>
+double measure_rounds(std::size_t lookups, std::size_t rounds, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    for ( std::size_t r = 0; r < rounds; ++r ) {
+        f();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(stop - start).count()
+        / static_cast<double>(rounds * lookups);
+}
+
+template<typename Map>
+void bench_batch(const char *name, const Map &m, const std::vector<std::uint32_t> &queries, std::size_t rounds) {
+    std::vector<ctmap::optional_t<std::uint32_t>> out(queries.size());
+    const double single = measure_rounds(queries.size(), rounds, [&] {
+        for ( std::size_t i = 0; i < queries.size(); ++i ) {
+            out[i] = m.find(queries[i]);
+        }
+    });
+    const double batch = measure_rounds(queries.size(), rounds, [&] {
+        m.find_batch(queries.data(), queries.size(), out.data());
+    });
+    std::printf("%-24s %10.2f %10.2f\n", name, single, batch);
+}
+
+template<std::size_t N>
+void bench_batch(std::size_t rounds) {
+    using sorted_t = ctmap::map<N, std::uint32_t, std::uint32_t, batch_cmp>;
+    using unordered_t = ctmap::unordered_map<N, std::uint32_t, std::uint32_t>;
+    using eytzinger_t = ctmap::eytzinger_map<N, std::uint32_t, std::uint32_t>;
+
+    // the tables are too big for a compile time build, they are built at runtime
+    auto data = std::make_unique<std::array<std::pair<std::uint32_t, std::uint32_t>, N>>();
+    for ( std::size_t i = 0; i < N; ++i ) {
+        (*data)[i] = {int_key(i), static_cast<std::uint32_t>(i)};
+    }
+    const auto sorted = std::make_unique<const sorted_t>(*data);
+    const auto unordered = std::make_unique<const unordered_t>(*data);
+    const auto eytzinger = std::make_unique<const eytzinger_t>(*data);
+    const ctmap::frozen_unordered_map<std::uint32_t, std::uint32_t> frozen{data->begin(), data->end()};
+
+    ctmap::details::splitmix64 rnd{N};
+    std::vector<std::uint32_t> queries;
+    for ( std::size_t i = 0; i < 65536; ++i ) {
+        const auto key = int_key(rnd() % N);
+        queries.push_back(i % 2 ? key : key + 1);
+    }
+
+    std::printf("N=%zu\n", N);
+    bench_batch("sorted_vector", *sorted, queries, rounds);
+    bench_batch("pmh_storage", *unordered, queries, rounds);
+    bench_batch("eytzinger_storage", *eytzinger, queries, rounds);
+    bench_batch("frozen_pmh_storage", frozen, queries, rounds);
+}
+
+// the sorted 64-bit ids with the gaps of up to 1000, built at runtime from a sorted array
+template<std::size_t N>
+void bench_compressed(std::size_t rounds) {
+    using sorted_t = ctmap::map<N, std::uint64_t, std::uint32_t>;
+    using compressed_t = ctmap::compressed_map<N, std::uint64_t, std::uint32_t>;
+
+    auto data = std::make_unique<std::array<std::pair<std::uint64_t, std::uint32_t>, N>>();
+    ctmap::details::splitmix64 rnd{N};
+    std::uint64_t key = 1ull << 40;
+    for ( std::size_t i = 0; i < N; ++i ) {
+        key += 1 + rnd() % 1000;
+        (*data)[i] = {key, static_cast<std::uint32_t>(i)};
+    }
+    const auto sorted = std::make_unique<const sorted_t>(ctmap::presorted, *data);
+    const auto compressed = std::make_unique<const compressed_t>(ctmap::presorted, *data);
+
+    std::vector<std::uint64_t> queries;
+    for ( std::size_t i = 0; i < 65536; ++i ) {
+        const auto k = (*data)[rnd() % N].first;
+        queries.push_back(i % 2 ? k : k + 1);
+    }
+
+    std::printf("N=%zu\n", N);
+    std::printf("%-24s %10.2f %10zu\n", "sorted_vector", measure(queries, rounds
+        ,[&m = *sorted](std::uint64_t k) { auto r = m.find(k); return r.first ? r.second : 0u; }), sizeof(sorted_t));
+    std::printf("%-24s %10.2f %10zu\n", "compressed_storage", measure(queries, rounds
+        ,[&m = *compressed](std::uint64_t k) { auto r = m.find(k); return r.first ? r.second : 0u; }), sizeof(compressed_t));
+}
+
+// the ranges of 10 with the gaps of 6 between them, the half of the points are in a gap
+template<std::size_t N>
+void bench_interval(std::size_t rounds) {
+    using interval_t = ctmap::interval_map<N, std::uint32_t, std::uint32_t>;
+
+    std::array<std::pair<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t>, N> data{};
+    std::map<std::uint32_t, std::pair<std::uint32_t, std::uint32_t>> std_map;
+    for ( std::uint32_t i = 0; i < N; ++i ) {
+        data[i] = {{i * 16, i * 16 + 10}, i};
+        std_map.emplace(i * 16, std::make_pair(i * 16 + 10, i));
+    }
+    const auto intervals = std::make_unique<const interval_t>(data);
+
+    ctmap::details::splitmix64 rnd{N};
+    std::vector<std::uint32_t> queries;
+    for ( std::size_t i = 0; i < 4096; ++i ) {
+        queries.push_back(static_cast<std::uint32_t>(rnd() % (N * 16)));
+    }
+
+    std::printf("N=%zu\n", N);
+    std::printf("%-24s %10.2f\n", "interval_map", measure(queries, rounds
+        ,[&m = *intervals](std::uint32_t k) { auto r = m.find(k); return r.first ? r.second : 0u; }));
+    std::printf("%-24s %10.2f\n", "std::map::upper_bound", measure(queries, rounds
+        ,[&std_map](std::uint32_t k) {
+            auto it = std_map.upper_bound(k);
+            return (it != std_map.begin() && k < (--it)->second.first) ? it->second.second : 0u;
+        }
+    ));
+}
+
+/*************************************************************************************************/
+
+int main() {
+    // 3/4 of the queries are hits, the rest are the hits with the last char changed
+    std::vector<std::string_view> queries;
+    std::vector<std::string> misses;
+    ctmap::details::splitmix64 rnd{42};
+    misses.reserve(4096);
+    for ( std::size_t i = 0; i < 4096; ++i ) {
+        const auto name = names[rnd() % num_names];
+        if ( i % 4 != 3 ) {
+            queries.push_back(name);
+        } else {
+            misses.emplace_back(name);
+            misses.back().back() = '_';
+            queries.push_back(misses.back());
+        }
+    }
+
+    const std::size_t rounds = 1000;
+    std::printf("%-24s %10s\n", "storage", "ns/lookup");
+    std::printf("%-24s %10.2f\n", "sorted_vector", measure(queries, rounds
+        ,[](std::string_view k) { auto r = sorted_map.find(k); return r.first ? r.second : 0u; }));
+    std::printf("%-24s %10.2f\n", "string_storage", measure(queries, rounds
+        ,[](std::string_view k) { auto r = string_map.find(k); return r.first ? r.second : 0u; }));
+    std::printf("%-24s %10.2f\n", "trie_storage", measure(queries, rounds
+        ,[](std::string_view k) { auto r = trie_map.find(k); return r.first ? r.second : 0u; }));
+    std::printf("%-24s %10.2f\n", "pmh_storage", measure(queries, rounds
+        ,[](std::string_view k) { auto r = unordered_map.find(k); return r.first ? r.second : 0u; }));
+
+    // the half of the queries are misses
+    std::vector<std::uint32_t> int_queries;
+    for ( std::size_t i = 0; i < 4096; ++i ) {
+        const auto key = int_key(rnd() % num_ints);
+        int_queries.push_back(i % 2 ? key : key + 1);
+    }
+
+    std::vector<std::uint32_t> small_queries;
+    for ( std::size_t i = 0; i < 4096; ++i ) {
+        const auto key = int_key(rnd() % 48);
+        small_queries.push_back(i % 2 ? key : key + 1);
+    }
+
+    std::printf("%-24s %10.2f\n", "sorted_vector<u32, 48>", measure(small_queries, rounds
+        ,[](std::uint32_t k) { auto r = small_sorted_map.find(k); return r.first ? r.second : 0u; }));
+    std::printf("%-24s %10.2f\n", "soa_storage<u32, 48>", measure(small_queries, rounds
+        ,[](std::uint32_t k) { auto r = small_soa_map.find(k); return r.first ? r.second : 0u; }));
+    std::vector<std::uint32_t> skewed_queries;
+    for ( std::size_t i = 0; i < 4096; ++i ) {
+        const std::size_t r = rnd() % 100;
+        skewed_queries.push_back(int_key(r < 70 ? 0 : r < 90 ? 1 : rnd() % 48));
+    }
+
+    std::printf("%-24s %10.2f\n", "sorted_vector<skewed>", measure(skewed_queries, rounds
+        ,[](std::uint32_t k) { auto r = small_sorted_map.find(k); return r.first ? r.second : 0u; }));
+    std::printf("%-24s %10.2f\n", "weighted_storage<skewed>", measure(skewed_queries, rounds
+        ,[](std::uint32_t k) { auto r = small_weighted_map.find(k); return r.first ? r.second : 0u; }));
+    std::printf("%-24s %10.2f\n", "sorted_vector<u32>", measure(int_queries, rounds
+        ,[](std::uint32_t k) { auto r = int_sorted_map.find(k); return r.first ? r.second : 0u; }));
+    std::printf("%-24s %10.2f\n", "soa_storage<u32>", measure(int_queries, rounds
+        ,[](std::uint32_t k) { auto r = int_soa_map.find(k); return r.first ? r.second : 0u; }));
+    std::printf("%-24s %10.2f\n", "eytzinger_storage<u32>", measure(int_queries, rounds
+        ,[](std::uint32_t k) { auto r = int_eytzinger_map.find(k); return r.first ? r.second : 0u; }));
+
+    std::vector<std::uint32_t> dense_queries;
+    for ( std::size_t i = 0; i < 4096; ++i ) {
+        dense_queries.push_back(static_cast<std::uint32_t>(rnd() % (num_ints + num_ints / 2)));
+    }
+
+    std::printf("%-24s %10.2f\n", "sorted_vector<dense>", measure(dense_queries, rounds
+        ,[](std::uint32_t k) { auto r = dense_sorted_map.find(k); return r.first ? r.second : 0u; }));
+    std::printf("%-24s %10.2f\n", "dense_storage", measure(dense_queries, rounds
+        ,[](std::uint32_t k) { auto r = dense_map.find(k); return r.first ? r.second : 0u; }));
+
+    std::printf("\n%-24s %10s %10s\n", "storage", "find", "find_batch");
+    bench_batch<1000>(100);
+    bench_batch<10000>(100);
+    bench_batch<100000>(100);
+
+    std::printf("\n%-24s %10s %10s\n", "storage", "ns/lookup", "bytes");
+    bench_compressed<100000>(50);
+    bench_compressed<1000000>(50);
+
+    std::printf("\n%-24s %10s\n", "intervals", "ns/lookup");
+    bench_interval<48>(1000);
+    bench_interval<4096>(1000);
+
+    return 0;
+}
+
+/*************************************************************************************************/
@@ -0,0 +1,112 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------
+
+#ifndef __CTMAP__BENCH__PERF_COUNTERS_HPP
+#define __CTMAP__BENCH__PERF_COUNTERS_HPP
+
+#include <cstdint>
+
+#if defined(__linux__)
+#   include <linux/perf_event.h>
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#endif // __linux__
+
+/*************************************************************************************************/
+
+// the hardware counters of the calling thread, via `perf_event_open()`.
+// when they are not available (not Linux, a VM, `perf_event_paranoid`) `available()` is false
+// and the benchmarks report the time only.
+struct perf_counters {
+    enum { branch_misses, cache_misses, num_counters };
+
+    perf_counters() {
+#if defined(__linux__)
+        const std::uint64_t configs[num_counters] = {
+             PERF_COUNT_HW_BRANCH_MISSES
+            ,PERF_COUNT_HW_CACHE_MISSES
+        };
+        for ( int i = 0; i < num_counters; ++i ) {
+            struct perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            m_fd[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif // __linux__
+    }
+    ~perf_counters() {
+#if defined(__linux__)
+        for ( int fd: m_fd ) {
+            if ( fd >= 0 ) {
+                ::close(fd);
+            }
+        }
+#endif // __linux__
+    }
+    perf_counters(const perf_counters &) = delete;
+    perf_counters& operator= (const perf_counters &) = delete;
+
+    bool available() const noexcept { return m_fd[branch_misses] >= 0 && m_fd[cache_misses] >= 0; }
+
+    void start() noexcept {
+#if defined(__linux__)
+        for ( int fd: m_fd ) {
+            if ( fd >= 0 ) {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif // __linux__
+    }
+    void stop() noexcept {
+#if defined(__linux__)
+        for ( int i = 0; i < num_counters; ++i ) {
+            m_values[i] = 0;
+            if ( m_fd[i] >= 0 ) {
+                ::ioctl(m_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+                if ( ::read(m_fd[i], &m_values[i], sizeof(m_values[i])) != sizeof(m_values[i]) ) {
+                    m_values[i] = 0;
+                }
+            }
+        }
+#endif // __linux__
+    }
+
+    std::uint64_t value(int counter) const noexcept { return m_values[counter]; }
+
+private:
+    int m_fd[num_counters]{-1, -1};
+    std::uint64_t m_values[num_counters]{};
+};
+
+/*************************************************************************************************/
+
+#endif // __CTMAP__BENCH__PERF_COUNTERS_HPP
@@ -0,0 +1,49 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "http_status.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+
+/*************************************************************************************************/
+
+int main(int argc, char **argv) {
+    static_assert(tables::http_status.size() == 21, "");
+    static_assert(tables::http_status.find(404).second == "Not Found", "");
+    static_assert(tables::http_status.find(418).second == "I'm a teapot", "");
+    static_assert(!tables::http_status.contains(299), "");
+
+    for ( int i = 1; i < argc; ++i ) {
+        const auto code = static_cast<std::uint16_t>(std::atoi(argv[i]));
+        const auto res = tables::http_status.find(code);
+        std::cout << code << ": " << (res.first ? res.second : "unknown") << std::endl;
+    }
+
+    return 0;
+}
+
+/*************************************************************************************************/
@@ -31,13 +31,81 @@
 #include <functional>
 #include <iterator>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <array>
+#include <string_view>
+#include <limits>
+#include <memory>
+#include <tuple>
+
+#if !defined(CTMAP_NO_SIMD)
+#   if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define CTMAP_HAS_SSE2 1
+#       include <emmintrin.h>
+#   endif
+#   if defined(__AVX2__)
+#       define CTMAP_HAS_AVX2 1
+#       include <immintrin.h>
+#   endif
+#endif
 
 namespace ctmap {
+
+// the tag for adopting an already sorted array (e.g. a generated one) without sorting it
+// again, only the order is verified, which is linear.
+struct presorted_t { explicit constexpr presorted_t() = default; };
+constexpr presorted_t presorted{};
+
 namespace details {
 
-// based on QuickSort from https://github.com/serge-sans-paille/frozen
+/*************************************************************************************************/
+
+constexpr bool is_constant_evaluated() noexcept {
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+    return __builtin_is_constant_evaluated();
+#else
+    return true;
+#endif
+}
+
+template<typename T>
+constexpr void prefetch(const T *p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    if ( !is_constant_evaluated() ) {
+        __builtin_prefetch(p);
+    }
+#else
+    (void)p;
+#endif
+}
+
+// number of trailing zero bits, `x` must not be zero.
+constexpr unsigned ctz64(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+    unsigned r = 0;
+    for ( ; !(x & 1u); x >>= 1 ) {
+        ++r;
+    }
+    return r;
+#endif
+}
+
+constexpr unsigned popcount64(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcountll(x));
+#else
+    unsigned r = 0;
+    for ( ; x; x &= x - 1 ) {
+        ++r;
+    }
+    return r;
+#endif
+}
+
+// cswap is based on https://github.com/serge-sans-paille/frozen
 // https://github.com/serge-sans-paille/frozen/blob/master/include/frozen/bits/algorithms.h
 /*************************************************************************************************/
 
@@ -55,9 +123,9 @@ constexpr auto min_element(Iter begin, const Iter end, Compare const &compare) {
 
 template <class T>
 constexpr void cswap(T &a, T &b) {
-    auto tmp = a;
-    a = b;
-    b = tmp;
+    auto tmp = std::move(a);
+    a = std::move(b);
+    b = std::move(tmp);
 }
 
 template <class T, class U>
@@ -82,37 +150,449 @@ constexpr void iter_swap(Iter a, Iter b) {
     cswap(*a, *b);
 }
 
-template <typename Iterator, class Compare>
-constexpr Iterator _partition(Iterator left, Iterator right, Compare const &compare) {
-    auto pivot = left + (right - left) / 2;
-    iter_swap(right, pivot);
-    pivot = right;
-    for (auto it = left; 0 < right - it; ++it) {
-        if (compare(*it, *pivot)) {
-            iter_swap(it, left);
-            left++;
+// the std::pair assignment is not constexpr in C++17, so all the sorting below is done by swaps.
+
+template<typename Iter, typename Compare>
+constexpr void insertion_sort(Iter first, Iter last, Compare const &compare) {
+    if ( first == last ) {
+        return;
+    }
+    for ( auto i = first + 1; i != last; ++i ) {
+        for ( auto j = i; j != first && compare(*j, *(j - 1)); --j ) {
+            iter_swap(j, j - 1);
+        }
+    }
+}
+
+template<typename Iter, typename Compare>
+constexpr void sift_down(Iter first, std::size_t root, std::size_t n, Compare const &compare) {
+    for ( std::size_t child = 2 * root + 1; child < n; child = 2 * root + 1 ) {
+        if ( child + 1 < n && compare(*(first + child), *(first + child + 1)) ) {
+            ++child;
+        }
+        if ( !compare(*(first + root), *(first + child)) ) {
+            return;
+        }
+        iter_swap(first + root, first + child);
+        root = child;
+    }
+}
+
+template<typename Iter, typename Compare>
+constexpr void heap_sort(Iter first, Iter last, Compare const &compare) {
+    const auto n = static_cast<std::size_t>(last - first);
+    for ( std::size_t i = n / 2; i > 0; --i ) {
+        sift_down(first, i - 1, n, compare);
+    }
+    for ( std::size_t i = n; i > 1; --i ) {
+        iter_swap(first, first + (i - 1));
+        sift_down(first, 0, i - 1, compare);
+    }
+}
+
+template<typename Iter, typename Compare>
+constexpr void move_median_to_first(Iter result, Iter a, Iter b, Iter c, Compare const &compare) {
+    if ( compare(*a, *b) ) {
+        if ( compare(*b, *c) ) {
+            iter_swap(result, b);
+        } else if ( compare(*a, *c) ) {
+            iter_swap(result, c);
+        } else {
+            iter_swap(result, a);
+        }
+    } else if ( compare(*a, *c) ) {
+        iter_swap(result, a);
+    } else if ( compare(*b, *c) ) {
+        iter_swap(result, c);
+    } else {
+        iter_swap(result, b);
+    }
+}
+
+// the Hoare partition around the median of three placed at `first`, the median is the
+// sentinel for both of the scans.
+template<typename Iter, typename Compare>
+constexpr Iter partition_pivot(Iter first, Iter last, Compare const &compare) {
+    move_median_to_first(first, first + 1, first + (last - first) / 2, last - 1, compare);
+    auto lo = first + 1;
+    auto hi = last;
+    for ( ;; ) {
+        while ( compare(*lo, *first) ) {
+            ++lo;
+        }
+        --hi;
+        while ( compare(*first, *hi) ) {
+            --hi;
+        }
+        if ( !(lo < hi) ) {
+            return lo;
         }
+        iter_swap(lo, hi);
+        ++lo;
     }
-    iter_swap(pivot, left);
-    pivot = left;
-    return pivot;
 }
 
-template<typename Iterator, class Compare>
-constexpr void quicksort(Iterator left, Iterator right, Compare const &compare) {
-    while (0 < right - left) {
-        auto new_pivot = _partition(left, right, compare);
-        quicksort(left, new_pivot, compare);
-        left = new_pivot + 1;
+// the iterative introsort: the larger partition is deferred to the explicit stack and the loop
+// continues with the smaller one, so the stack depth is log2(N) at most. when the partitioning
+// depth exceeds 2*log2(N) the range is heap sorted, the small ranges are insertion sorted.
+template<typename Iter, typename Compare>
+constexpr void sort(Iter first, Iter last, Compare const &compare) {
+    struct range {
+        Iter first;
+        Iter last;
+        std::size_t depth;
+    };
+
+    std::size_t depth = 0;
+    for ( auto n = last - first; n > 1; n >>= 1 ) {
+        depth += 2;
+    }
+
+    range stack[64]{};
+    std::size_t top = 0;
+    stack[top++] = range{first, last, depth};
+    while ( top ) {
+        range r = stack[--top];
+        while ( r.last - r.first > 16 && r.depth > 0 ) {
+            --r.depth;
+            const auto cut = partition_pivot(r.first, r.last, compare);
+            if ( cut - r.first < r.last - cut ) {
+                stack[top++] = range{cut, r.last, r.depth};
+                r.last = cut;
+            } else {
+                stack[top++] = range{r.first, cut, r.depth};
+                r.first = cut;
+            }
+        }
+        if ( r.last - r.first > 16 ) {
+            heap_sort(r.first, r.last, compare);
+        } else {
+            insertion_sort(r.first, r.last, compare);
+        }
     }
 }
 
 template<typename Container, class Compare>
-constexpr Container quicksort(Container array, Compare const &compare) {
-    quicksort(array.begin(), array.end() - 1, compare);
+constexpr Container sort(Container array, Compare const &compare) {
+    details::sort(array.begin(), array.end(), compare);
     return array;
 }
 
+// sorts equal elements keeping their original order: the indices are sorted with the
+// position as the tie breaker, then the permutation is applied in place by the cycles.
+template<typename T, std::size_t N, typename Compare>
+constexpr void stable_sort(std::array<T, N> &arr, Compare const &compare) {
+    std::array<std::size_t, N> idx{};
+    for ( std::size_t i = 0; i < N; ++i ) {
+        idx[i] = i;
+    }
+    details::sort(idx.begin(), idx.end(), [&arr, &compare](std::size_t l, std::size_t r) {
+        return compare(arr[l], arr[r]) || (!compare(arr[r], arr[l]) && l < r);
+    });
+    for ( std::size_t i = 0; i < N; ++i ) {
+        std::size_t j = i;
+        while ( idx[j] != i ) {
+            const std::size_t next = idx[j];
+            cswap(arr[j], arr[next]);
+            idx[j] = j;
+            j = next;
+        }
+        idx[j] = j;
+    }
+}
+
+/*************************************************************************************************/
+
+template<typename T>
+constexpr const T& key_of(const T &v) noexcept { return v; }
+
+template<typename K, typename V>
+constexpr const K& key_of(const std::pair<K, V> &v) noexcept { return v.first; }
+
+template<typename T>
+using key_type_t = std::decay_t<decltype(key_of(std::declval<const T &>()))>;
+
+template<std::size_t N>
+using index_type_t = std::conditional_t<(N <= 0xffu), std::uint8_t,
+    std::conditional_t<(N <= 0xffffu), std::uint16_t,
+    std::conditional_t<(N <= 0xffffffffu), std::uint32_t, std::size_t>>>;
+
+template<typename K, bool = std::is_enum<K>::value>
+struct key_int { using type = K; };
+
+template<typename K>
+struct key_int<K, true> { using type = std::underlying_type_t<K>; };
+
+template<typename K>
+using key_int_t = typename key_int<K>::type;
+
+template<typename K>
+constexpr std::uint64_t key_bits(const K &k) noexcept
+{ return static_cast<std::uint64_t>(static_cast<key_int_t<K>>(k)); }
+
+/*************************************************************************************************/
+// the searches are comparing the keys only, with the key comparator of the element comparator:
+// `less_key` declares it, the `std::less`/`std::greater` of the elements are ordering the
+// unique keys the same way as the transparent `std::less<>`/`std::greater<>`, and for any other
+// comparator the keys are wrapped into the probe elements.
+
+template<typename T, typename KeyLess = std::less<>>
+struct less_key {
+    using key_compare = KeyLess;
+
+    constexpr bool operator()(const T &l, const T &r)
+        const noexcept(noexcept(KeyLess{}(key_of(l), key_of(r))))
+    { return KeyLess{}(key_of(l), key_of(r)); }
+};
+
+template<typename T>
+struct is_pair: std::false_type {};
+
+template<typename K, typename V>
+struct is_pair<std::pair<K, V>>: std::true_type {};
+
+template<typename CmpLess, typename T>
+struct probe_compare {
+    template<typename A, typename B>
+    constexpr bool operator()(const A &a, const B &b) const
+    { return CmpLess{}(probe(a), probe(b)); }
+
+private:
+    template<typename A>
+    static constexpr T probe(const A &a) {
+        if constexpr ( is_pair<T>::value ) {
+            return T{typename T::first_type(a), typename T::second_type{}};
+        } else {
+            return T(a);
+        }
+    }
+};
+
+template<typename CmpLess, typename T, typename = void>
+struct key_compare { using type = probe_compare<CmpLess, T>; };
+
+template<typename CmpLess, typename T>
+struct key_compare<CmpLess, T, std::void_t<typename CmpLess::key_compare>>
+{ using type = typename CmpLess::key_compare; };
+
+template<typename U, typename T>
+struct key_compare<std::less<U>, T, void> { using type = std::less<>; };
+
+template<typename U, typename T>
+struct key_compare<std::greater<U>, T, void> { using type = std::greater<>; };
+
+template<typename CmpLess, typename T>
+using key_compare_t = typename key_compare<CmpLess, T>::type;
+
+// the storages relying on the numeric or lexicographic order of the keys
+template<typename CmpLess, typename T>
+constexpr bool is_natural_order_v = std::is_same<key_compare_t<CmpLess, T>, std::less<>>::value;
+
+// the hashed storages are testing the hits with `==`, which agrees only with the natural order
+// and its reverse
+template<typename CmpLess, typename T>
+constexpr bool is_equality_order_v = is_natural_order_v<CmpLess, T>
+    || std::is_same<key_compare_t<CmpLess, T>, std::greater<>>::value;
+
+template<typename Storage, typename = void>
+struct storage_key_compare { using type = std::less<>; };
+
+template<typename Storage>
+struct storage_key_compare<Storage, std::void_t<typename Storage::key_compare>>
+{ using type = typename Storage::key_compare; };
+
+template<typename Storage>
+using storage_key_compare_t = typename storage_key_compare<Storage>::type;
+
+template<typename Cmp, typename = void>
+struct is_transparent: std::false_type {};
+
+template<typename Cmp>
+struct is_transparent<Cmp, std::void_t<typename Cmp::is_transparent>>: std::true_type {};
+
+// the lookups are using the key as is when the comparator is transparent (e.g. `std::less<>` of
+// `less_key`), so a `string_view` keyed map is searched with a `const char *` or a `std::string`
+// without a temporary. the arithmetic keys are always converted, the mixed signedness comparisons
+// are a trap.
+template<typename KeyCompare, typename K, typename Key>
+using lookup_key_t = std::conditional_t<
+     is_transparent<KeyCompare>::value && !std::is_arithmetic<K>::value && !std::is_enum<K>::value
+    ,Key
+    ,K
+>;
+
+// `K{From}` is ill-formed when narrowing, but the compilers are only warning about it in an
+// instantiated template, the detection is turning it into a substitution failure
+template<typename K, typename From, typename = void>
+struct is_brace_convertible: std::false_type {};
+
+template<typename K, typename From>
+struct is_brace_convertible<K, From, std::void_t<decltype(K{std::declval<From>()})>>
+    : std::true_type
+{};
+
+template<typename Storage, typename Key, typename = void>
+struct has_contains: std::false_type {};
+
+template<typename Storage, typename Key>
+struct has_contains<Storage, Key, std::void_t<decltype(std::declval<const Storage &>().contains(std::declval<const Key &>()))>>
+    : std::true_type
+{};
+
+template<typename Storage, typename Key, typename = void>
+struct has_find_index_batch: std::false_type {};
+
+template<typename Storage, typename Key>
+struct has_find_index_batch<Storage, Key, std::void_t<decltype(
+    std::declval<const Storage &>().find_index_batch(
+        std::declval<const Key *>(), std::size_t{}, std::declval<std::size_t *>()))>>
+    : std::true_type
+{};
+
+// the lookup statistics are counting the probes per key: `find_index_probes(k, probes)` is the
+// `find_index(k)` of a storage adding the probes it takes to `probes`, the searches are
+// counting them with `counting_compare`.
+template<typename Storage, typename Key, typename = void>
+struct has_find_index_probes: std::false_type {};
+
+template<typename Storage, typename Key>
+struct has_find_index_probes<Storage, Key, std::void_t<decltype(
+    std::declval<const Storage &>().find_index_probes(std::declval<const Key &>(), std::declval<std::size_t &>()))>>
+    : std::true_type
+{};
+
+// counts the calls of the key comparator
+template<typename KeyLess>
+struct counting_compare {
+    std::size_t *count;
+
+    template<typename A, typename B>
+    constexpr bool operator()(const A &a, const B &b) const {
+        ++*count;
+        return KeyLess{}(a, b);
+    }
+};
+
+// the number of the compares of a binary search over `n` keys, about log2(n)+1
+constexpr std::size_t search_depth(std::size_t n) noexcept {
+    std::size_t depth = 0;
+    for ( ; n; n >>= 1 ) {
+        ++depth;
+    }
+    return depth;
+}
+
+constexpr std::size_t next_pow2(std::size_t n) noexcept {
+    std::size_t r = 1;
+    while ( r < n ) {
+        r <<= 1;
+    }
+    return r;
+}
+
+// the search kernels works on an iterator + size, so they can be shared by all the storages.
+// returns the index of the found element, or `n` if not found.
+template<typename Iter, typename Key, typename KeyLess = std::less<>>
+constexpr std::size_t lower_bound_index(Iter beg, std::size_t n, const Key &k, const KeyLess &less = KeyLess{}) noexcept {
+    const auto first = beg;
+    std::size_t count = n;
+
+    while ( count > 0 ) {
+        if ( less(key_of(*(beg+count/2)), k) ) {
+            beg = beg+count/2+1;
+            count -= count/2+1;
+        } else {
+            count = count/2;
+        }
+    }
+
+    return static_cast<std::size_t>(beg - first);
+}
+
+template<typename Iter, typename Key, typename KeyLess = std::less<>>
+constexpr std::size_t upper_bound_index(Iter beg, std::size_t n, const Key &k, const KeyLess &less = KeyLess{}) noexcept {
+    const auto first = beg;
+    std::size_t count = n;
+
+    while ( count > 0 ) {
+        if ( !less(k, key_of(*(beg+count/2))) ) {
+            beg = beg+count/2+1;
+            count -= count/2+1;
+        } else {
+            count = count/2;
+        }
+    }
+
+    return static_cast<std::size_t>(beg - first);
+}
+
+// the found key is equivalent to `k`, the lower bound guarantees it's not less than `k`.
+template<typename Iter, typename Key, typename KeyLess = std::less<>>
+constexpr std::size_t find_index(Iter beg, std::size_t n, const Key &k, const KeyLess &less = KeyLess{}) noexcept {
+    const auto idx = lower_bound_index(beg, n, k, less);
+    return (idx != n && !less(k, key_of(*(beg+idx)))) ? idx : n;
+}
+
+// returns the index of the first element which key is equal (or equivalent) to the previous one, or `n`.
+// the builders are throwing on a duplicate, as on the other invalid input: in a constant
+// expression the throw is a compile error pointing at it.
+template<typename Iter, typename Compare>
+constexpr std::size_t find_duplicate(Iter beg, std::size_t n, Compare const &compare) {
+    for ( std::size_t i = 1; i < n; ++i ) {
+        if ( key_of(*(beg+i-1)) == key_of(*(beg+i)) || !compare(*(beg+i-1), *(beg+i)) ) {
+            return i;
+        }
+    }
+
+    return n;
+}
+
+// the number of the searches running interleaved by the batch kernels.
+constexpr std::size_t batch_group = 16;
+
+// runs up to `batch_group` branchless binary searches in lockstep, so the cache misses of the
+// different keys are overlapping. `out` receives the indices as `find_index()` does.
+template<typename Iter, typename Key, typename KeyLess = std::less<>>
+constexpr void find_index_group(
+     Iter beg
+    ,std::size_t n
+    ,const Key *keys
+    ,std::size_t count
+    ,std::size_t *out
+    ,const KeyLess &less = KeyLess{}) noexcept
+{
+    std::size_t base[batch_group]{};
+    std::size_t len = n;
+    while ( len > 1 ) {
+        const std::size_t half = len / 2;
+        len -= half;
+        for ( std::size_t j = 0; j < count; ++j ) {
+            base[j] = less(key_of(*(beg + base[j] + half)), keys[j]) ? base[j] + half : base[j];
+            // the next probe of this key, while the other keys are probed
+            prefetch(&*(beg + base[j] + len / 2));
+        }
+    }
+    for ( std::size_t j = 0; j < count; ++j ) {
+        const std::size_t idx = (n == 0) ? 0 : base[j] + static_cast<std::size_t>(less(key_of(*(beg + base[j])), keys[j]));
+        out[j] = (idx != n && !less(keys[j], key_of(*(beg + idx)))) ? idx : n;
+    }
+}
+
+template<typename Iter, typename Key, typename KeyLess = std::less<>>
+constexpr void find_index_batch(
+     Iter beg
+    ,std::size_t n
+    ,const Key *keys
+    ,std::size_t count
+    ,std::size_t *out
+    ,const KeyLess &less = KeyLess{}) noexcept
+{
+    for ( std::size_t i = 0; i < count; i += batch_group ) {
+        const std::size_t group = (count - i < batch_group) ? count - i : batch_group;
+        find_index_group(beg, n, keys + i, group, out + i, less);
+    }
+}
+
 /*************************************************************************************************/
 
 template<std::size_t N, typename T, typename CmpLess = std::less<T>>
@@ -121,11 +601,31 @@ private:
     using StorageType = std::array<T, N>;
     StorageType m_data;
 
-    constexpr sorted_vector(StorageType arr)
-        :m_data{quicksort(std::move(arr), CmpLess{})}
-    {}
-
 public:
+    using key_compare = key_compare_t<CmpLess, T>;
+
+    // sorted in place, the big tables built at runtime are not copied to the stack
+    constexpr sorted_vector(const StorageType &arr)
+        :m_data{arr}
+    {
+        details::sort(m_data.begin(), m_data.end(), CmpLess{});
+        if ( find_duplicate(m_data.begin(), N, CmpLess{}) != N ) {
+            throw std::invalid_argument("ctmap: duplicate keys");
+        }
+    }
+    constexpr sorted_vector(presorted_t, const StorageType &arr)
+        :m_data{arr}
+    {
+        for ( std::size_t i = 1; i < N; ++i ) {
+            if ( CmpLess{}(m_data[i], m_data[i - 1]) ) {
+                throw std::invalid_argument("ctmap: the presorted elements are not sorted");
+            }
+        }
+        if ( find_duplicate(m_data.begin(), N, CmpLess{}) != N ) {
+            throw std::invalid_argument("ctmap: duplicate keys");
+        }
+    }
+
     template<typename ...U>
     constexpr sorted_vector(U ...elems)
         :sorted_vector{StorageType{std::move(elems)...}}
@@ -137,6 +637,18 @@ public:
 
     constexpr auto& operator[](std::size_t i) const noexcept { return m_data[i]; }
 
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &k) const noexcept
+    { return details::find_index(begin(), N, k, key_compare{}); }
+
+    template<typename Key>
+    constexpr std::size_t find_index_probes(const Key &k, std::size_t &probes) const noexcept
+    { return details::find_index(begin(), N, k, counting_compare<key_compare>{&probes}); }
+
+    template<typename Key>
+    constexpr void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept
+    { details::find_index_batch(begin(), N, keys, count, out, key_compare{}); }
+
     template<std::size_t NN, typename RCmpLess, typename CmpEqual>
     constexpr bool equal(const sorted_vector<NN, T, RCmpLess> &r, const CmpEqual &cmp) const noexcept {
         if constexpr ( N != NN ) {
@@ -151,6 +663,20 @@ public:
 
         return true;
     }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept {
+        if ( r.size() != N ) {
+            return false;
+        }
+        for ( std::size_t i = 0; i < N; ++i ) {
+            if ( !cmp(m_data[i], r[i]) ) {
+                return false;
+            }
+        }
+
+        return true;
+    }
 };
 
 template<typename T, typename CmpLess>
@@ -159,16 +685,34 @@ private:
     const T m_data[1];
 
 public:
+    using key_compare = key_compare_t<CmpLess, T>;
+
     constexpr sorted_vector(T x)
         :m_data{std::move(x)}
     {}
+    constexpr sorted_vector(std::array<T, 1> arr)
+        :m_data{std::move(arr[0])}
+    {}
+    constexpr sorted_vector(presorted_t, std::array<T, 1> arr)
+        :m_data{std::move(arr[0])}
+    {}
 
-    constexpr auto  size()  const noexcept { return 1; }
-    constexpr auto* begin() const noexcept { return m_data.begin(); }
-    constexpr auto* end  () const noexcept { return m_data.end(); }
+    constexpr std::size_t size() const noexcept { return 1; }
+    constexpr auto* begin() const noexcept { return m_data; }
+    constexpr auto* end  () const noexcept { return m_data + 1; }
 
     constexpr auto& operator[](std::size_t i) const noexcept { return m_data[i]; }
 
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &k) const noexcept
+    { return (!key_compare{}(key_of(m_data[0]), k) && !key_compare{}(k, key_of(m_data[0]))) ? 0 : 1; }
+
+    template<typename Key>
+    constexpr std::size_t find_index_probes(const Key &k, std::size_t &probes) const noexcept {
+        const counting_compare<key_compare> less{&probes};
+        return (!less(key_of(m_data[0]), k) && !less(k, key_of(m_data[0]))) ? 0 : 1;
+    }
+
     template<std::size_t NN, typename RCmpLess, typename CmpEqual>
     constexpr bool equal(const sorted_vector<NN, T, RCmpLess> &r, const CmpEqual &cmp) const noexcept {
         if constexpr ( 1 != NN ) {
@@ -177,6 +721,10 @@ public:
 
         return cmp(*(begin()), *(r.begin()));
     }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept
+    { return r.size() == 1 && cmp(m_data[0], r[0]); }
 };
 
 template<typename T, typename CmpLess>
@@ -184,14 +732,26 @@ struct sorted_vector<0, T, CmpLess> {
 private:
 
 public:
+    using key_compare = key_compare_t<CmpLess, T>;
+
     constexpr sorted_vector()
     {}
+    constexpr sorted_vector(std::array<T, 0>)
+    {}
+    constexpr sorted_vector(presorted_t, std::array<T, 0>)
+    {}
+
+    constexpr std::size_t size() const noexcept { return 0; }
+    constexpr const T* begin() const noexcept { return nullptr; }
+    constexpr const T* end  () const noexcept { return nullptr; }
 
-    constexpr auto  size()  const noexcept { return 0; }
-    constexpr auto* begin() const noexcept { return nullptr; }
-    constexpr auto* end  () const noexcept { return nullptr; }
+    constexpr const T& operator[](std::size_t /*i*/) const { throw std::invalid_argument("zero size vector!"); }
 
-    constexpr auto& operator[](std::size_t /*i*/) const { throw std::invalid_argument("zero size vector!"); }
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &/*k*/) const noexcept { return 0; }
+
+    template<typename Key>
+    constexpr std::size_t find_index_probes(const Key &/*k*/, std::size_t &/*probes*/) const noexcept { return 0; }
 
     template<std::size_t NN, typename RCmpLess, typename CmpEqual>
     constexpr bool equal(const sorted_vector<NN, T, RCmpLess> &/*r*/, const CmpEqual &/*cmp*/) const noexcept
@@ -213,110 +773,1948 @@ constexpr auto make_sorted_vector_cmp(CmpLess, T && t, Ts && ...ts) {
 }
 
 /*************************************************************************************************/
+// the perfect hashing is based on the CHD algorithm:
+// http://cmph.sourceforge.net/papers/esa09.pdf
 
-} // ns details
+constexpr std::uint64_t mix64(std::uint64_t x) noexcept {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
 
-/*************************************************************************************************/
+struct splitmix64 {
+    std::uint64_t state;
 
-template<typename T>
-using optional_t = std::pair<bool, T>;
+    constexpr std::uint64_t operator()() noexcept {
+        state += 0x9e3779b97f4a7c15ull;
+        return mix64(state);
+    }
+};
 
-template<
-     std::size_t N
-    ,typename K
-    ,typename V
-    ,typename CmpLess = std::less<std::pair<K, V>>
-    ,typename Storage = details::sorted_vector<N, std::pair<K, V>, CmpLess>
->
-struct map {
-    template<typename... Ts>
-    constexpr map(Ts && ...ts)
-        :vec{std::forward<Ts>(ts)...}
-    {}
+template<typename K, typename = void>
+struct hash;
 
-    constexpr auto* begin() const noexcept { return vec.begin(); }
-    constexpr auto* end  () const noexcept { return vec.end  (); }
-    constexpr auto  size () const noexcept { return vec.size();  }
-    constexpr const auto& storage() const noexcept { return vec; }
+template<typename K>
+struct hash<K, std::enable_if_t<std::is_integral<K>::value || std::is_enum<K>::value>> {
+    constexpr std::uint64_t operator()(const K &k, std::uint64_t seed) const noexcept {
+        return mix64(static_cast<std::uint64_t>(k) ^ seed);
+    }
+};
 
-    constexpr optional_t<V> find(const K &k) const noexcept { return lower_bound(k); }
-    constexpr bool contains(const K &k)      const noexcept { return lower_bound(k).first; }
+template<typename CharT, typename Traits>
+struct hash<std::basic_string_view<CharT, Traits>> {
+    constexpr std::uint64_t operator()(std::basic_string_view<CharT, Traits> k, std::uint64_t seed) const noexcept {
+        // FNV-1a
+        std::uint64_t h = 0xcbf29ce484222325ull ^ seed;
+        for ( const auto c: k ) {
+            h ^= static_cast<std::uint64_t>(c);
+            h *= 0x100000001b3ull;
+        }
+        return mix64(h);
+    }
+};
 
-    constexpr auto& operator[](std::size_t i) const noexcept { return vec[i]; }
+// the `g` tables entry is either a seed for the second level hash, or an index into
+// the `h` table if the `pmh_direct` bit is set.
+constexpr std::uint64_t pmh_direct = 1ull << 63;
 
-    template<std::size_t NN, typename RCmpLess, typename RStorage, typename CmpEqual>
-    constexpr bool equal(const map<NN, K, V, RCmpLess, RStorage> &r, const CmpEqual &cmp) const noexcept {
-        if constexpr ( N != NN ) {
-            return false;
-        } else {
-            return vec.equal(r.storage(), cmp);
-        }
+// calls `f` with a zeroed scratch of `S` elements: a local array in a constant expression, and
+// at runtime an allocated one, which would take megabytes of the stack for the big maps.
+template<std::size_t S, typename F>
+constexpr auto with_local_scratch(F &f) {
+    std::array<std::size_t, S> scratch{};
+    return f(scratch.data());
+}
+
+template<typename F>
+auto with_heap_scratch(std::size_t size, F &f) {
+    const std::unique_ptr<std::size_t[]> scratch{new std::size_t[size]{}};
+    return f(scratch.get());
+}
+
+template<std::size_t S, typename F>
+constexpr auto with_scratch(F &&f) {
+    if ( is_constant_evaluated() ) {
+        return with_local_scratch<S>(f);
     }
-private:
-    constexpr optional_t<V> lower_bound(const K &k) const noexcept {
-        const auto *beg = vec.begin();
-        const auto *end = vec.end();
-        std::size_t count = N;
+    return with_heap_scratch(S, f);
+}
 
-        while ( count > 0 ) {
-            if ( (beg+count/2)->first < k ) {
-                beg = beg+count/2+1;
-                count -= count/2+1;
-            } else {
-                count = count/2;
+// `scratch` must point to `n + 2*m + 1` elements.
+template<typename Iter, typename Hash, typename Index>
+constexpr std::uint64_t pmh_build(
+     Iter data
+    ,std::size_t n
+    ,std::size_t m
+    ,const Hash &hasher
+    ,std::uint64_t *g
+    ,Index *h
+    ,std::size_t *scratch)
+{
+    std::size_t *order = scratch;
+    std::size_t *first = order + n;
+    // used as the bucket cursors while distributing, and as the slot stamps while placing
+    std::size_t *stamp = first + m + 1;
+
+    const std::size_t mask = m - 1;
+    splitmix64 rnd{n};
+
+    for ( std::size_t attempt = 0; attempt < 64; ++attempt ) {
+        const std::uint64_t seed = rnd() & ~pmh_direct;
+        for ( std::size_t i = 0; i < m; ++i ) {
+            g[i] = 0;
+            h[i] = static_cast<Index>(n);
+            first[i] = 0;
+        }
+        first[m] = 0;
+
+        // distribute the keys into the buckets
+        std::size_t max_size = 0;
+        for ( std::size_t i = 0; i < n; ++i ) {
+            ++first[(hasher(key_of(*(data+i)), seed) & mask) + 1];
+        }
+        for ( std::size_t i = 0; i < m; ++i ) {
+            if ( first[i+1] > max_size ) {
+                max_size = first[i+1];
             }
+            first[i+1] += first[i];
+            stamp[i] = first[i];
         }
-        if ( beg != end ) {
-            return {(beg->first == k), beg->second};
+        for ( std::size_t i = 0; i < n; ++i ) {
+            order[stamp[hasher(key_of(*(data+i)), seed) & mask]++] = i;
         }
-        return {false, V{}};
-    }
-
-private:
-    Storage vec;
-};
+        for ( std::size_t i = 0; i < m; ++i ) {
+            stamp[i] = 0;
+        }
+        std::size_t gen = 0;
 
-template<
-     typename K
-    ,typename V
-    ,typename CmpLess
-    ,typename Storage
->
-struct map<1, K, V, CmpLess, Storage> {
-    template<typename... Ts>
-    constexpr map(Ts && ...ts)
-        :vec{std::forward<Ts>(ts)...}
-    {}
+        // place the biggest buckets first
+        bool ok = true;
+        for ( std::size_t size = max_size; ok && size > 1; --size ) {
+            for ( std::size_t b = 0; ok && b < m; ++b ) {
+                if ( first[b+1] - first[b] != size ) {
+                    continue;
+                }
 
-    constexpr auto& operator[](std::size_t i) const noexcept { return vec[i]; }
+                ok = false;
+                for ( std::size_t tries = 0; !ok && tries < (1u << 12); ++tries ) {
+                    const std::uint64_t d = rnd() & ~pmh_direct;
+                    ++gen;
+                    ok = true;
+                    for ( std::size_t j = first[b]; j < first[b+1]; ++j ) {
+                        const std::size_t slot = hasher(key_of(*(data+order[j])), d) & mask;
+                        if ( h[slot] != static_cast<Index>(n) || stamp[slot] == gen ) {
+                            ok = false;
+                            break;
+                        }
+                        stamp[slot] = gen;
+                    }
+                    if ( ok ) {
+                        for ( std::size_t j = first[b]; j < first[b+1]; ++j ) {
+                            const std::size_t slot = hasher(key_of(*(data+order[j])), d) & mask;
+                            h[slot] = static_cast<Index>(order[j]);
+                        }
+                        g[b] = d;
+                    }
+                }
+            }
+        }
+        if ( !ok ) {
+            continue;
+        }
 
-    constexpr auto* begin() const noexcept { return vec.begin(); }
-    constexpr auto* end  () const noexcept { return vec.end  (); }
-    constexpr auto  size () const noexcept { return vec.size (); }
+        // the single-key buckets are pointing directly to the free slots
+        std::size_t free = 0;
+        for ( std::size_t b = 0; b < m; ++b ) {
+            if ( first[b+1] - first[b] == 1 ) {
+                while ( h[free] != static_cast<Index>(n) ) {
+                    ++free;
+                }
+                h[free] = static_cast<Index>(order[first[b]]);
+                g[b] = pmh_direct | free;
+            }
+        }
 
-    constexpr optional_t<V> find(const K &k) const noexcept {
-        return vec[0].first == k
-            ? optional_t<V>{true, vec[0].second}
-            : optional_t<V>{false, V{}}
-        ;
+        return seed;
     }
-    constexpr bool contains(const K &k) const noexcept { return find(k).first; }
 
-private:
-    Storage vec;
-};
+    throw std::invalid_argument("ctmap: unable to build the perfect hash, duplicate keys?");
+}
 
-/***********************************************************************************/
+template<typename Key, typename Hash>
+constexpr std::size_t pmh_slot(
+     const Key &k
+    ,std::uint64_t seed
+    ,const std::uint64_t *g
+    ,std::size_t m
+    ,const Hash &hasher) noexcept
+{
+    const std::uint64_t d = g[hasher(k, seed) & (m - 1)];
+    return (d & pmh_direct)
+        ? static_cast<std::size_t>(d & ~pmh_direct)
+        : static_cast<std::size_t>(hasher(k, d) & (m - 1))
+    ;
+}
 
-template<typename K, typename V, template<typename, typename> class ...Pairs>
-constexpr auto make_map(Pairs<K, V> && ...ts) {
-    using value_type = std::pair<K, V>;
-    struct cmp_less {
-        constexpr bool operator()(const value_type &l, const value_type &r)
-            const noexcept(noexcept(l.first < r.first))
-        { return l.first < r.first; }
+template<typename Iter, typename Index, typename Hash, typename Key>
+constexpr std::size_t pmh_find_index(
+     Iter data
+    ,std::size_t n
+    ,std::uint64_t seed
+    ,const std::uint64_t *g
+    ,const Index *h
+    ,std::size_t m
+    ,const Hash &hasher
+    ,const Key &k) noexcept
+{
+    const std::size_t idx = h[pmh_slot(k, seed, g, m, hasher)];
+    return (idx != n && key_of(*(data+idx)) == k) ? idx : n;
+}
+
+// every stage of the lookup is done for the whole group, prefetching for the next stage
+template<typename Iter, typename Index, typename Hash, typename Key>
+constexpr void pmh_find_index_batch(
+     Iter data
+    ,std::size_t n
+    ,std::uint64_t seed
+    ,const std::uint64_t *g
+    ,const Index *h
+    ,std::size_t m
+    ,const Hash &hasher
+    ,const Key *keys
+    ,std::size_t count
+    ,std::size_t *out) noexcept
+{
+    for ( std::size_t i = 0; i < count; i += batch_group ) {
+        const std::size_t group = (count - i < batch_group) ? count - i : batch_group;
+        const Key *k = keys + i;
+        std::size_t *o = out + i;
+
+        for ( std::size_t j = 0; j < group; ++j ) {
+            o[j] = hasher(k[j], seed) & (m - 1);
+            prefetch(g + o[j]);
+        }
+        for ( std::size_t j = 0; j < group; ++j ) {
+            const std::uint64_t d = g[o[j]];
+            o[j] = (d & pmh_direct)
+                ? static_cast<std::size_t>(d & ~pmh_direct)
+                : static_cast<std::size_t>(hasher(k[j], d) & (m - 1))
+            ;
+            prefetch(h + o[j]);
+        }
+        for ( std::size_t j = 0; j < group; ++j ) {
+            o[j] = h[o[j]];
+            if ( o[j] != n ) {
+                prefetch(&*(data+o[j]));
+            }
+        }
+        for ( std::size_t j = 0; j < group; ++j ) {
+            o[j] = (o[j] != n && key_of(*(data+o[j])) == k[j]) ? o[j] : n;
+        }
+    }
+}
+
+// keeps the sorted order for the iteration, and the perfect hash tables for the lookup.
+template<
+     std::size_t N
+    ,typename T
+    ,typename CmpLess = std::less<T>
+    ,typename Hash = hash<key_type_t<T>>
+>
+struct pmh_storage {
+public:
+    // the lookups are comparing with `==`, the order is used by the iteration and the bounds
+    using key_compare = key_compare_t<CmpLess, T>;
+
+private:
+    static_assert(N > 0, "pmh_storage requires at least one key");
+    static_assert(is_equality_order_v<CmpLess, T>
+        ,"pmh_storage requires the natural order of the keys or its reverse, the hits are tested with `==`");
+    static constexpr std::size_t M = next_pow2(N);
+    using index_type = index_type_t<N>;
+
+    sorted_vector<N, T, CmpLess> m_vec;
+    std::uint64_t m_seed;
+    std::array<std::uint64_t, M> m_g;
+    std::array<index_type, M> m_h;
+
+public:
+    template<typename ...U>
+    constexpr pmh_storage(U && ...elems)
+        :m_vec{std::forward<U>(elems)...}
+        ,m_seed{}
+        ,m_g{}
+        ,m_h{}
+    {
+        m_seed = with_scratch<N + 2*M + 1>([this](std::size_t *scratch) {
+            return pmh_build(m_vec.begin(), N, M, Hash{}, m_g.data(), m_h.data(), scratch);
+        });
+    }
+
+    constexpr auto  size()  const noexcept { return N; }
+    constexpr auto* begin() const noexcept { return m_vec.begin(); }
+    constexpr auto* end  () const noexcept { return m_vec.end(); }
+
+    constexpr auto& operator[](std::size_t i) const noexcept { return m_vec[i]; }
+
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &k) const noexcept
+    { return pmh_find_index(m_vec.begin(), N, m_seed, m_g.data(), m_h.data(), M, Hash{}, k); }
+
+    // one key compare, unless the slot is empty
+    template<typename Key>
+    constexpr std::size_t find_index_probes(const Key &k, std::size_t &probes) const noexcept {
+        const std::size_t idx = m_h[pmh_slot(k, m_seed, m_g.data(), M, Hash{})];
+        if ( idx == N ) {
+            return N;
+        }
+        ++probes;
+        return (key_of(m_vec[idx]) == k) ? idx : N;
+    }
+
+    template<typename Key>
+    constexpr void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept
+    { pmh_find_index_batch(m_vec.begin(), N, m_seed, m_g.data(), m_h.data(), M, Hash{}, keys, count, out); }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept
+    { return m_vec.equal(r, cmp); }
+};
+
+/*************************************************************************************************/
+// the Eytzinger layout: https://algorithmica.org/en/eytzinger
+
+template<typename Iter, typename Key, typename Index>
+constexpr std::size_t eytzinger_build(
+     Iter data
+    ,std::size_t n
+    ,std::size_t i
+    ,std::size_t k
+    ,Key *keys
+    ,Index *ranks) noexcept
+{
+    if ( k <= n ) {
+        i = eytzinger_build(data, n, i, 2*k, keys, ranks);
+        keys[k] = key_of(*(data+i));
+        ranks[k] = static_cast<Index>(i++);
+        i = eytzinger_build(data, n, i, 2*k+1, keys, ranks);
+    }
+    return i;
+}
+
+// returns the 1-based Eytzinger index of the first key not less than `k`, or zero.
+template<typename Key, typename KK, typename KeyLess = std::less<>>
+constexpr std::size_t eytzinger_lower_bound(const Key *keys, std::size_t n, const KK &k, const KeyLess &less = KeyLess{}) noexcept {
+    // the number of keys fitting into a cache line, it's the four levels ahead
+    constexpr std::size_t block = (64 / sizeof(Key)) ? (64 / sizeof(Key)) : 1;
+
+    std::size_t i = 1;
+    while ( i <= n ) {
+        if ( i*block <= n ) {
+            prefetch(keys + i*block);
+        }
+        i = 2*i + static_cast<std::size_t>(less(keys[i], k));
+    }
+
+    return i >> (ctz64(~static_cast<std::uint64_t>(i)) + 1);
+}
+
+// `keys` and `ranks` are 1-based, `ranks[0]` must be `n`.
+template<typename Iter, typename Key, typename Index, typename KK, typename KeyLess = std::less<>>
+constexpr std::size_t eytzinger_find_index(
+     Iter data
+    ,std::size_t n
+    ,const Key *keys
+    ,const Index *ranks
+    ,const KK &k
+    ,const KeyLess &less = KeyLess{}) noexcept
+{
+    const std::size_t idx = ranks[eytzinger_lower_bound(keys, n, k, less)];
+    return (idx != n && !less(k, key_of(*(data+idx)))) ? idx : n;
+}
+
+template<typename Iter, typename Key, typename Index, typename KK, typename KeyLess = std::less<>>
+constexpr void eytzinger_find_index_batch(
+     Iter data
+    ,std::size_t n
+    ,const Key *keys
+    ,const Index *ranks
+    ,const KK *kk
+    ,std::size_t count
+    ,std::size_t *out
+    ,const KeyLess &less = KeyLess{}) noexcept
+{
+    constexpr std::size_t block = (64 / sizeof(Key)) ? (64 / sizeof(Key)) : 1;
+    // the number of the complete levels, log2 of the largest power of two not greater than n + 1
+    const std::size_t full_levels = ctz64(next_pow2(n + 2) / 2);
+    for ( std::size_t i = 0; i < count; i += batch_group ) {
+        const std::size_t group = (count - i < batch_group) ? count - i : batch_group;
+        const KK *k = kk + i;
+        std::size_t *o = out + i;
+
+        for ( std::size_t j = 0; j < group; ++j ) {
+            o[j] = 1;
+        }
+        // all the lanes are descending through the complete levels together,
+        // and only the last, incomplete level needs a check
+        for ( std::size_t level = 0; level < full_levels; ++level ) {
+            for ( std::size_t j = 0; j < group; ++j ) {
+                o[j] = 2*o[j] + static_cast<std::size_t>(less(keys[o[j]], k[j]));
+                if ( o[j]*block <= n ) {
+                    prefetch(keys + o[j]*block);
+                }
+            }
+        }
+        for ( std::size_t j = 0; j < group; ++j ) {
+            if ( o[j] <= n ) {
+                o[j] = 2*o[j] + static_cast<std::size_t>(less(keys[o[j]], k[j]));
+            }
+        }
+        for ( std::size_t j = 0; j < group; ++j ) {
+            const std::size_t idx = ranks[o[j] >> (ctz64(~static_cast<std::uint64_t>(o[j])) + 1)];
+            o[j] = (idx != n && !less(k[j], key_of(*(data+idx)))) ? idx : n;
+        }
+    }
+}
+
+// keeps the sorted order for the iteration, and the keys in the Eytzinger order for the lookup.
+template<
+     std::size_t N
+    ,typename T
+    ,typename CmpLess = std::less<T>
+>
+struct eytzinger_storage {
+public:
+    using key_compare = key_compare_t<CmpLess, T>;
+
+private:
+    static_assert(N > 0, "eytzinger_storage requires at least one key");
+    using key_type = key_type_t<T>;
+    using index_type = index_type_t<N>;
+
+    sorted_vector<N, T, CmpLess> m_vec;
+    // the both are 1-based, the zero element of `m_ranks` is the "not found" marker
+    std::array<key_type, N + 1> m_keys;
+    std::array<index_type, N + 1> m_ranks;
+
+public:
+    template<typename ...U>
+    constexpr eytzinger_storage(U && ...elems)
+        :m_vec{std::forward<U>(elems)...}
+        ,m_keys{}
+        ,m_ranks{}
+    {
+        eytzinger_build(m_vec.begin(), N, 0, 1, m_keys.data(), m_ranks.data());
+        m_ranks[0] = static_cast<index_type>(N);
+    }
+
+    constexpr auto  size()  const noexcept { return N; }
+    constexpr auto* begin() const noexcept { return m_vec.begin(); }
+    constexpr auto* end  () const noexcept { return m_vec.end(); }
+
+    constexpr auto& operator[](std::size_t i) const noexcept { return m_vec[i]; }
+
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &k) const noexcept
+    { return eytzinger_find_index(m_vec.begin(), N, m_keys.data(), m_ranks.data(), k, key_compare{}); }
+
+    template<typename Key>
+    constexpr std::size_t find_index_probes(const Key &k, std::size_t &probes) const noexcept {
+        return eytzinger_find_index(m_vec.begin(), N, m_keys.data(), m_ranks.data(), k
+            ,counting_compare<key_compare>{&probes});
+    }
+
+    template<typename Key>
+    constexpr void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept
+    { eytzinger_find_index_batch(m_vec.begin(), N, m_keys.data(), m_ranks.data(), keys, count, out, key_compare{}); }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept
+    { return m_vec.equal(r, cmp); }
+};
+
+/*************************************************************************************************/
+
+// the "hot keys first" layout: up to `H` most frequently looked up keys are compared one by one
+// before the search over all of them. the weights are the expected access frequencies of the
+// entries, and the number of the hot keys minimizes the expected number of the compares.
+template<
+     std::size_t N
+    ,typename T
+    ,typename CmpLess = std::less<T>
+    ,std::size_t H = 4
+>
+struct weighted_storage {
+public:
+    using key_compare = key_compare_t<CmpLess, T>;
+
+private:
+    using key_type = key_type_t<T>;
+    using index_type = index_type_t<N>;
+    static constexpr std::size_t max_hot = (H < N) ? H : N;
+
+    sorted_vector<N, T, CmpLess> m_vec;
+    std::array<key_type, max_hot> m_hot_keys;
+    std::array<index_type, max_hot> m_hot_ranks;
+    std::size_t m_hot;
+
+public:
+    constexpr weighted_storage(const std::array<T, N> &arr, const std::array<std::uint64_t, N> &weights)
+        :m_vec{arr}
+        ,m_hot_keys{}
+        ,m_hot_ranks{}
+        ,m_hot{}
+    {
+        // by the descending weight, the equal weights in the definition order
+        std::array<std::pair<std::uint64_t, std::size_t>, N> order{};
+        std::uint64_t total = 0;
+        for ( std::size_t i = 0; i < N; ++i ) {
+            order[i].first = weights[i];
+            order[i].second = i;
+            total += weights[i];
+        }
+        stable_sort(order, [](const auto &l, const auto &r) { return l.first > r.first; });
+
+        // the expected cost of `h` hot keys, multiplied by the total weight: the i-th hot key
+        // takes i compares, and the rest are taking `h` compares before the search.
+        const std::uint64_t search = search_depth(N);
+        std::uint64_t best = total * search;
+        std::uint64_t hot_cost = 0;
+        std::uint64_t hot_weight = 0;
+        for ( std::size_t h = 1; h <= max_hot; ++h ) {
+            hot_cost += order[h - 1].first * h;
+            hot_weight += order[h - 1].first;
+            const std::uint64_t cost = hot_cost + (total - hot_weight) * (h + search);
+            if ( cost < best ) {
+                best = cost;
+                m_hot = h;
+            }
+        }
+        for ( std::size_t i = 0; i < m_hot; ++i ) {
+            m_hot_keys[i] = key_of(arr[order[i].second]);
+            m_hot_ranks[i] = static_cast<index_type>(m_vec.find_index(m_hot_keys[i]));
+        }
+    }
+
+    constexpr auto  size()  const noexcept { return N; }
+    constexpr auto* begin() const noexcept { return m_vec.begin(); }
+    constexpr auto* end  () const noexcept { return m_vec.end(); }
+
+    constexpr auto& operator[](std::size_t i) const noexcept { return m_vec[i]; }
+
+    // the number of the keys scanned before the search
+    constexpr std::size_t hot_size() const noexcept { return m_hot; }
+
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &k) const noexcept {
+        for ( std::size_t i = 0; i < m_hot; ++i ) {
+            if ( is_hot(i, k) ) {
+                return m_hot_ranks[i];
+            }
+        }
+
+        return m_vec.find_index(k);
+    }
+
+    // a hot key counts as one probe
+    template<typename Key>
+    constexpr std::size_t find_index_probes(const Key &k, std::size_t &probes) const noexcept {
+        for ( std::size_t i = 0; i < m_hot; ++i ) {
+            ++probes;
+            if ( is_hot(i, k) ) {
+                return m_hot_ranks[i];
+            }
+        }
+
+        return m_vec.find_index_probes(k, probes);
+    }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept
+    { return m_vec.equal(r, cmp); }
+
+private:
+    template<typename Key>
+    constexpr bool is_hot(std::size_t i, const Key &k) const noexcept {
+        if constexpr ( is_natural_order_v<CmpLess, T> ) {
+            return m_hot_keys[i] == k;
+        } else {
+            return !key_compare{}(k, m_hot_keys[i]) && !key_compare{}(m_hot_keys[i], k);
+        }
+    }
+};
+
+/*************************************************************************************************/
+
+// random access iterator for the storages which are not keeping the `std::pair`s,
+// dereferencing returns the `operator[]` result by value.
+template<typename Storage>
+struct index_iterator {
+    using value_type = std::decay_t<decltype(std::declval<const Storage &>()[0])>;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+    using iterator_category = std::random_access_iterator_tag;
+
+    struct pointer {
+        value_type v;
+        constexpr const value_type* operator->() const noexcept { return &v; }
     };
-    return map<sizeof...(Pairs), K, V, cmp_less>{std::forward<Pairs<K, V>>(ts)...};
+
+    const Storage *s;
+    std::size_t i;
+
+    constexpr reference operator* () const noexcept { return (*s)[i]; }
+    constexpr pointer   operator->() const noexcept { return {(*s)[i]}; }
+    constexpr reference operator[](difference_type n) const noexcept { return (*s)[i + n]; }
+
+    constexpr index_iterator& operator++() noexcept { ++i; return *this; }
+    constexpr index_iterator& operator--() noexcept { --i; return *this; }
+    constexpr index_iterator  operator++(int) noexcept { auto t = *this; ++i; return t; }
+    constexpr index_iterator  operator--(int) noexcept { auto t = *this; --i; return t; }
+    constexpr index_iterator& operator+=(difference_type n) noexcept { i += n; return *this; }
+    constexpr index_iterator& operator-=(difference_type n) noexcept { i -= n; return *this; }
+
+    friend constexpr index_iterator operator+(index_iterator it, difference_type n) noexcept { return it += n; }
+    friend constexpr index_iterator operator+(difference_type n, index_iterator it) noexcept { return it += n; }
+    friend constexpr index_iterator operator-(index_iterator it, difference_type n) noexcept { return it -= n; }
+    friend constexpr difference_type operator-(const index_iterator &l, const index_iterator &r) noexcept
+    { return static_cast<difference_type>(l.i) - static_cast<difference_type>(r.i); }
+
+    friend constexpr bool operator==(const index_iterator &l, const index_iterator &r) noexcept { return l.i == r.i; }
+    friend constexpr bool operator!=(const index_iterator &l, const index_iterator &r) noexcept { return l.i != r.i; }
+    friend constexpr bool operator< (const index_iterator &l, const index_iterator &r) noexcept { return l.i <  r.i; }
+    friend constexpr bool operator> (const index_iterator &l, const index_iterator &r) noexcept { return l.i >  r.i; }
+    friend constexpr bool operator<=(const index_iterator &l, const index_iterator &r) noexcept { return l.i <= r.i; }
+    friend constexpr bool operator>=(const index_iterator &l, const index_iterator &r) noexcept { return l.i >= r.i; }
+};
+
+/*************************************************************************************************/
+
+// the membership of the integral keys within a range of `Bits` from the smallest one, e.g. the
+// character classes: `contains()` is a bounds check, a shift and a mask.
+template<
+     std::size_t N
+    ,typename T
+    ,typename CmpLess = std::less<T>
+    ,std::size_t Bits = 256
+>
+struct bitmask_storage {
+public:
+    using key_compare = std::less<>;
+
+private:
+    static_assert(is_natural_order_v<CmpLess, T>, "bitmask_storage requires the natural order of the keys");
+    static_assert(std::is_integral<key_type_t<T>>::value || std::is_enum<key_type_t<T>>::value
+        ,"bitmask_storage requires the integral or enum keys");
+    static_assert(N > 0, "bitmask_storage requires at least one key");
+    static_assert(Bits > 0 && Bits % 64 == 0, "bitmask_storage requires a multiple of 64 bits");
+
+    using key_type = key_type_t<T>;
+    static constexpr std::size_t W = Bits / 64;
+
+    sorted_vector<N, T, CmpLess> m_vec;
+    key_type m_min;
+    std::array<std::uint64_t, W> m_bits;
+
+public:
+    template<typename ...U>
+    constexpr bitmask_storage(U && ...elems)
+        :m_vec{std::forward<U>(elems)...}
+        ,m_min{key_of(m_vec[0])}
+        ,m_bits{}
+    {
+        for ( std::size_t i = 0; i < N; ++i ) {
+            const std::uint64_t off = key_bits(key_of(m_vec[i])) - key_bits(m_min);
+            if ( off >= Bits ) {
+                throw std::invalid_argument("ctmap: the keys range is wider than the bitmask");
+            }
+            m_bits[off / 64] |= 1ull << (off % 64);
+        }
+    }
+
+    constexpr auto  size()  const noexcept { return N; }
+    constexpr auto* begin() const noexcept { return m_vec.begin(); }
+    constexpr auto* end  () const noexcept { return m_vec.end(); }
+
+    constexpr auto& operator[](std::size_t i) const noexcept { return m_vec[i]; }
+
+    constexpr bool contains(const key_type &k) const noexcept {
+        const std::uint64_t off = key_bits(k) - key_bits(m_min);
+        return off < Bits && ((m_bits[off / 64] >> (off % 64)) & 1u);
+    }
+
+    // the rank of the key in the bitmask
+    constexpr std::size_t find_index(const key_type &k) const noexcept {
+        if ( !contains(k) ) {
+            return N;
+        }
+        const std::uint64_t off = key_bits(k) - key_bits(m_min);
+        std::size_t rank = popcount64(m_bits[off / 64] & ((1ull << (off % 64)) - 1));
+        for ( std::size_t w = 0; w < off / 64; ++w ) {
+            rank += popcount64(m_bits[w]);
+        }
+
+        return rank;
+    }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept
+    { return m_vec.equal(r, cmp); }
+};
+
+/*************************************************************************************************/
+
+template<typename K>
+constexpr bool is_simd_key_v =
+    (std::is_integral<K>::value || std::is_enum<K>::value)
+    && (sizeof(K) == 1 || sizeof(K) == 2 || sizeof(K) == 4 || sizeof(K) == 8)
+;
+
+// defined with the other SIMD kernels below
+template<typename K>
+inline std::size_t simd_linear_find(const K *keys, std::size_t n, const K &k) noexcept;
+
+// when the integral keys are occupying at least a half of their [min, max] range, the lookup is
+// a bounds check and a load: the index is the key offset if the range has no holes, or the rank
+// of the key in the presence bitmap otherwise. the sparse keys are binary searched.
+template<
+     std::size_t N
+    ,typename T
+    ,typename CmpLess = std::less<T>
+>
+struct dense_storage {
+public:
+    using key_compare = std::less<>;
+
+private:
+    static_assert(N > 0, "dense_storage requires at least one key");
+    static_assert(is_natural_order_v<CmpLess, T>, "dense_storage requires the natural order of the keys");
+
+    using key_type = key_type_t<T>;
+    using index_type = index_type_t<N>;
+
+    enum dense_mode { sparse, full, holes };
+    static constexpr std::size_t W = (2 * N + 63) / 64;
+    // the sparse keys fitting into four cache lines are compared all at once with SIMD
+    static constexpr bool simd_scan = is_simd_key_v<key_type> && N * sizeof(key_type) <= 256;
+
+    sorted_vector<N, T, CmpLess> m_vec;
+    key_type m_min;
+    std::uint64_t m_range;
+    dense_mode m_mode;
+    std::array<std::uint64_t, W> m_bits;
+    std::array<index_type, W> m_counts;
+    std::array<key_type, simd_scan ? N : 0> m_keys;
+
+public:
+    template<typename ...U>
+    constexpr dense_storage(U && ...elems)
+        :m_vec{std::forward<U>(elems)...}
+        ,m_min{key_of(m_vec[0])}
+        ,m_range{key_bits(key_of(m_vec[N-1])) - key_bits(m_min) + 1}
+        ,m_mode{sparse}
+        ,m_bits{}
+        ,m_counts{}
+        ,m_keys{}
+    {
+        if ( m_range == 0 || m_range > W * 64 ) {
+            if constexpr ( simd_scan ) {
+                for ( std::size_t i = 0; i < N; ++i ) {
+                    m_keys[i] = key_of(m_vec[i]);
+                }
+            }
+            return;
+        }
+        if ( m_range == N ) {
+            m_mode = full;
+            return;
+        }
+
+        m_mode = holes;
+        for ( std::size_t i = 0; i < N; ++i ) {
+            const std::uint64_t off = key_bits(key_of(m_vec[i])) - key_bits(m_min);
+            m_bits[off / 64] |= 1ull << (off % 64);
+        }
+        std::size_t count = 0;
+        for ( std::size_t w = 0; w < W; ++w ) {
+            m_counts[w] = static_cast<index_type>(count);
+            count += popcount64(m_bits[w]);
+        }
+    }
+
+    constexpr auto  size()  const noexcept { return N; }
+    constexpr auto* begin() const noexcept { return m_vec.begin(); }
+    constexpr auto* end  () const noexcept { return m_vec.end(); }
+
+    constexpr auto& operator[](std::size_t i) const noexcept { return m_vec[i]; }
+
+    constexpr bool is_dense() const noexcept { return m_mode != sparse; }
+
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &k) const noexcept {
+        if constexpr ( std::is_same<Key, key_type>::value ) {
+            if ( m_mode != sparse ) {
+                const std::uint64_t off = key_bits(k) - key_bits(m_min);
+                if ( off >= m_range ) {
+                    return N;
+                }
+                if ( m_mode == full ) {
+                    return static_cast<std::size_t>(off);
+                }
+
+                const std::uint64_t word = m_bits[off / 64];
+                const std::uint64_t bit = 1ull << (off % 64);
+                return (word & bit)
+                    ? m_counts[off / 64] + popcount64(word & (bit - 1))
+                    : N
+                ;
+            }
+            if constexpr ( simd_scan ) {
+                if ( !is_constant_evaluated() ) {
+                    return simd_linear_find(m_keys.data(), N, k);
+                }
+            }
+        }
+
+        return m_vec.find_index(k);
+    }
+
+    // the direct addressing is one probe, the scan probes the keys up to the found one
+    template<typename Key>
+    constexpr std::size_t find_index_probes(const Key &k, std::size_t &probes) const noexcept {
+        if constexpr ( std::is_same<Key, key_type>::value ) {
+            if ( m_mode != sparse ) {
+                ++probes;
+                return find_index(k);
+            }
+            if constexpr ( simd_scan ) {
+                if ( !is_constant_evaluated() ) {
+                    const std::size_t idx = simd_linear_find(m_keys.data(), N, k);
+                    probes += (idx != N) ? idx + 1 : N;
+                    return idx;
+                }
+            }
+        }
+
+        return m_vec.find_index_probes(k, probes);
+    }
+
+    template<typename Key>
+    constexpr void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept {
+        if ( m_mode == sparse && !simd_scan ) {
+            m_vec.find_index_batch(keys, count, out);
+        } else {
+            for ( std::size_t i = 0; i < count; ++i ) {
+                out[i] = find_index(keys[i]);
+            }
+        }
+    }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept
+    { return m_vec.equal(r, cmp); }
+};
+
+/*************************************************************************************************/
+
+// the first 8 bytes of the string as a big-endian integer, zero padded. the order of the
+// prefixes is consistent with the lexicographical order of the strings.
+constexpr std::uint64_t string_prefix(std::string_view s) noexcept {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if ( !is_constant_evaluated() && s.size() >= 8 ) {
+        std::uint64_t r = 0;
+        __builtin_memcpy(&r, s.data(), 8);
+        return __builtin_bswap64(r);
+    }
+#endif
+    std::uint64_t r = 0;
+    for ( std::size_t i = 0; i < 8; ++i ) {
+        r = (r << 8) | ((i < s.size()) ? static_cast<unsigned char>(s[i]) : 0u);
+    }
+    return r;
+}
+
+// the string keys: most of the binary search steps are comparing the precomputed 8 bytes
+// prefixes, the rest of the string is compared only when the prefixes are equal.
+template<
+     std::size_t N
+    ,typename T
+    ,typename CmpLess = std::less<T>
+>
+struct string_storage {
+public:
+    using key_compare = std::less<>;
+
+private:
+    static_assert(N > 0, "string_storage requires at least one key");
+    static_assert(std::is_same<key_type_t<T>, std::string_view>::value
+        ,"string_storage requires std::string_view keys");
+    static_assert(is_natural_order_v<CmpLess, T>, "string_storage requires the lexicographic order of the keys");
+
+    sorted_vector<N, T, CmpLess> m_vec;
+    std::array<std::uint64_t, N> m_prefixes;
+    std::array<std::uint32_t, N> m_sizes;
+
+    // compares the strings having equal prefixes
+    static constexpr int compare_rest(std::string_view l, std::string_view r) noexcept {
+        const int c = l.substr(l.size() < 8 ? l.size() : 8).compare(r.substr(r.size() < 8 ? r.size() : 8));
+        return c ? c : (l.size() < r.size() ? -1 : (r.size() < l.size() ? 1 : 0));
+    }
+
+public:
+    template<typename ...U>
+    constexpr string_storage(U && ...elems)
+        :m_vec{std::forward<U>(elems)...}
+        ,m_prefixes{}
+        ,m_sizes{}
+    {
+        for ( std::size_t i = 0; i < N; ++i ) {
+            m_prefixes[i] = string_prefix(key_of(m_vec[i]));
+            m_sizes[i] = static_cast<std::uint32_t>(key_of(m_vec[i]).size());
+        }
+    }
+
+    constexpr auto  size()  const noexcept { return N; }
+    constexpr auto* begin() const noexcept { return m_vec.begin(); }
+    constexpr auto* end  () const noexcept { return m_vec.end(); }
+
+    constexpr auto& operator[](std::size_t i) const noexcept { return m_vec[i]; }
+
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &key) const noexcept {
+        const std::string_view k{key};
+        const std::uint64_t p = string_prefix(k);
+
+        std::size_t beg = 0;
+        std::size_t count = N;
+        while ( count > 0 ) {
+            const std::size_t i = beg + count/2;
+            const bool less = (m_prefixes[i] != p)
+                ? m_prefixes[i] < p
+                : compare_rest(key_of(m_vec[i]), k) < 0
+            ;
+            if ( less ) {
+                beg = i + 1;
+                count -= count/2 + 1;
+            } else {
+                count = count/2;
+            }
+        }
+
+        return (beg != N
+            && m_prefixes[beg] == p
+            && m_sizes[beg] == k.size()
+            && compare_rest(key_of(m_vec[beg]), k) == 0)
+            ? beg
+            : N
+        ;
+    }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept
+    { return m_vec.equal(r, cmp); }
+};
+
+/*************************************************************************************************/
+
+// the compressed (PATRICIA) byte trie over the string keys. every internal node branches on the
+// byte at the position where the keys of its subtree are starting to differ, so the lookup reads
+// every byte of the input once at most, and compares the whole string only at the leaf.
+// the symbol `0` is the end of the string, the bytes are `1 + byte`.
+template<
+     std::size_t N
+    ,typename T
+    ,typename CmpLess = std::less<T>
+>
+struct trie_storage {
+public:
+    using key_compare = std::less<>;
+
+private:
+    static_assert(std::is_same<key_type_t<T>, std::string_view>::value
+        ,"trie_storage requires std::string_view keys");
+    static_assert(is_natural_order_v<CmpLess, T>, "trie_storage requires the lexicographic order of the keys");
+
+    // a trie over N keys has N-1 internal nodes and 2N-2 edges at most
+    static constexpr std::size_t NN = (N > 1) ? N - 1 : 1;
+    static constexpr std::size_t NE = (N > 1) ? 2 * N - 2 : 1;
+    static constexpr std::uint32_t leaf = 0x80000000u;
+
+    struct node {
+        std::uint32_t pos;
+        std::uint32_t first;
+        std::uint32_t count;
+    };
+
+    sorted_vector<N, T, CmpLess> m_vec;
+    std::array<node, NN> m_nodes;
+    std::array<std::uint16_t, NE> m_symbols;
+    std::array<std::uint32_t, NE> m_children;
+
+    static constexpr std::uint16_t symbol(std::string_view s, std::size_t pos) noexcept
+    { return (pos < s.size()) ? static_cast<std::uint16_t>(1u + static_cast<unsigned char>(s[pos])) : 0u; }
+
+public:
+    template<typename ...U>
+    constexpr trie_storage(U && ...elems)
+        :m_vec{std::forward<U>(elems)...}
+        ,m_nodes{}
+        ,m_symbols{}
+        ,m_children{}
+    {
+        if constexpr ( N > 1 ) {
+            // the nodes are created in BFS order, the ranges of the keys are waiting in the queue
+            std::array<std::size_t, NN> lo{};
+            std::array<std::size_t, NN> hi{};
+            lo[0] = 0;
+            hi[0] = N;
+            std::size_t nodes = 1;
+            std::size_t edges = 0;
+            for ( std::size_t n = 0; n < nodes; ++n ) {
+                const std::string_view l = key_of(m_vec[lo[n]]);
+                const std::string_view r = key_of(m_vec[hi[n] - 1]);
+                std::size_t pos = 0;
+                while ( pos < l.size() && pos < r.size() && l[pos] == r[pos] ) {
+                    ++pos;
+                }
+
+                m_nodes[n] = node{static_cast<std::uint32_t>(pos), static_cast<std::uint32_t>(edges), 0};
+                for ( std::size_t i = lo[n]; i < hi[n]; ) {
+                    const std::uint16_t sym = symbol(key_of(m_vec[i]), pos);
+                    std::size_t j = i + 1;
+                    while ( j < hi[n] && symbol(key_of(m_vec[j]), pos) == sym ) {
+                        ++j;
+                    }
+                    if ( i == lo[n] && j == hi[n] ) {
+                        throw std::invalid_argument("ctmap: duplicate keys");
+                    }
+
+                    m_symbols[edges] = sym;
+                    if ( j - i == 1 ) {
+                        m_children[edges] = leaf | static_cast<std::uint32_t>(i);
+                    } else {
+                        lo[nodes] = i;
+                        hi[nodes] = j;
+                        m_children[edges] = static_cast<std::uint32_t>(nodes++);
+                    }
+                    ++edges;
+                    ++m_nodes[n].count;
+                    i = j;
+                }
+            }
+        }
+    }
+
+    constexpr auto  size()  const noexcept { return N; }
+    constexpr auto* begin() const noexcept { return m_vec.begin(); }
+    constexpr auto* end  () const noexcept { return m_vec.end(); }
+
+    constexpr auto& operator[](std::size_t i) const noexcept { return m_vec[i]; }
+
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &key) const noexcept {
+        const std::string_view k{key};
+        std::uint32_t child = leaf;
+        if constexpr ( N > 1 ) {
+            for ( std::uint32_t n = 0; ; n = child ) {
+                const node &nd = m_nodes[n];
+                const std::uint16_t sym = symbol(k, nd.pos);
+                // the edges are sorted by the symbol
+                std::uint32_t e = nd.first;
+                const std::uint32_t last = nd.first + nd.count;
+                while ( e < last && m_symbols[e] < sym ) {
+                    ++e;
+                }
+                if ( e == last || m_symbols[e] != sym ) {
+                    return N;
+                }
+                child = m_children[e];
+                if ( child & leaf ) {
+                    break;
+                }
+            }
+        }
+
+        const std::size_t idx = child & ~leaf;
+        return (key_of(m_vec[idx]) == k) ? idx : N;
+    }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept
+    { return m_vec.equal(r, cmp); }
+};
+
+/*************************************************************************************************/
+// the SIMD kernels for the integral keys. all of them are runtime only, the callers must
+// fall back to the scalar search under the constant evaluation.
+
+#if defined(CTMAP_HAS_SSE2)
+template<std::size_t Size>
+inline __m128i sse_set1(std::uint64_t v) noexcept {
+    if constexpr ( Size == 1 ) {
+        return _mm_set1_epi8(static_cast<char>(v));
+    } else if constexpr ( Size == 2 ) {
+        return _mm_set1_epi16(static_cast<short>(v));
+    } else if constexpr ( Size == 4 ) {
+        return _mm_set1_epi32(static_cast<int>(v));
+    } else {
+        return _mm_set1_epi64x(static_cast<long long>(v));
+    }
+}
+
+template<std::size_t Size>
+inline __m128i sse_cmpeq(__m128i a, __m128i b) noexcept {
+    if constexpr ( Size == 1 ) {
+        return _mm_cmpeq_epi8(a, b);
+    } else if constexpr ( Size == 2 ) {
+        return _mm_cmpeq_epi16(a, b);
+    } else if constexpr ( Size == 4 ) {
+        return _mm_cmpeq_epi32(a, b);
+    } else {
+        // SSE2 has no 64-bit compare: both of the 32-bit halves must be equal
+        const __m128i c = _mm_cmpeq_epi32(a, b);
+        return _mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+}
+#endif // CTMAP_HAS_SSE2
+
+#if defined(CTMAP_HAS_AVX2)
+template<std::size_t Size>
+inline __m256i avx_set1(std::uint64_t v) noexcept {
+    if constexpr ( Size == 1 ) {
+        return _mm256_set1_epi8(static_cast<char>(v));
+    } else if constexpr ( Size == 2 ) {
+        return _mm256_set1_epi16(static_cast<short>(v));
+    } else if constexpr ( Size == 4 ) {
+        return _mm256_set1_epi32(static_cast<int>(v));
+    } else {
+        return _mm256_set1_epi64x(static_cast<long long>(v));
+    }
+}
+
+template<std::size_t Size>
+inline __m256i avx_cmpeq(__m256i a, __m256i b) noexcept {
+    if constexpr ( Size == 1 ) {
+        return _mm256_cmpeq_epi8(a, b);
+    } else if constexpr ( Size == 2 ) {
+        return _mm256_cmpeq_epi16(a, b);
+    } else if constexpr ( Size == 4 ) {
+        return _mm256_cmpeq_epi32(a, b);
+    } else {
+        return _mm256_cmpeq_epi64(a, b);
+    }
+}
+#endif // CTMAP_HAS_AVX2
+
+// compares all the keys at once with the SIMD compare + movemask.
+// returns the index of the key, or `n` if not found.
+template<typename K>
+inline std::size_t simd_linear_find(const K *keys, std::size_t n, const K &k) noexcept {
+    std::size_t i = 0;
+#if defined(CTMAP_HAS_AVX2)
+    {
+        constexpr std::size_t lanes = 32 / sizeof(K);
+        const __m256i needle = avx_set1<sizeof(K)>(key_bits(k));
+        for ( ; i + lanes <= n; i += lanes ) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+            const auto mask = static_cast<std::uint32_t>(
+                _mm256_movemask_epi8(avx_cmpeq<sizeof(K)>(v, needle)));
+            if ( mask ) {
+                return i + ctz64(mask) / sizeof(K);
+            }
+        }
+    }
+#endif
+#if defined(CTMAP_HAS_SSE2)
+    {
+        constexpr std::size_t lanes = 16 / sizeof(K);
+        const __m128i needle = sse_set1<sizeof(K)>(key_bits(k));
+        for ( ; i + lanes <= n; i += lanes ) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+            const auto mask = static_cast<std::uint32_t>(
+                _mm_movemask_epi8(sse_cmpeq<sizeof(K)>(v, needle)));
+            if ( mask ) {
+                return i + ctz64(mask) / sizeof(K);
+            }
+        }
+    }
+#endif
+    for ( ; i < n; ++i ) {
+        if ( keys[i] == k ) {
+            return i;
+        }
+    }
+
+    return n;
+}
+
+// number of the keys in the node which are less than `k`.
+template<std::size_t B, typename K>
+inline std::size_t simd_count_less(const K *node, const K &k) noexcept {
+#if defined(CTMAP_HAS_SSE2)
+    if constexpr ( sizeof(K) == 4 && B % 4 == 0 ) {
+        // SSE2 compares are signed only, the unsigned keys are biased into the signed range
+        constexpr std::uint32_t bias = std::is_signed<key_int_t<K>>::value ? 0u : 0x80000000u;
+        const __m128i b = _mm_set1_epi32(static_cast<int>(bias));
+        const __m128i x = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(key_bits(k))), b);
+        std::size_t cnt = 0;
+        for ( std::size_t i = 0; i < B; i += 4 ) {
+            const __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(node + i)), b);
+            const auto mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x, v))));
+            cnt += static_cast<std::size_t>((mask & 1u) + ((mask >> 1) & 1u) + ((mask >> 2) & 1u) + (mask >> 3));
+        }
+        return cnt;
+    } else
+#endif
+    {
+        std::size_t cnt = 0;
+        for ( std::size_t i = 0; i < B; ++i ) {
+            cnt += static_cast<std::size_t>(node[i] < k);
+        }
+        return cnt;
+    }
+}
+
+// the static B-tree (S-tree) layout: https://algorithmica.org/en/s-tree
+// the node `k` has the children `k * (B + 1) + i + 1`.
+template<std::size_t B, typename Iter, typename K, typename Index>
+constexpr std::size_t btree_build(
+     Iter keys
+    ,std::size_t n
+    ,std::size_t nblocks
+    ,std::size_t t
+    ,std::size_t k
+    ,K *tree
+    ,Index *ranks) noexcept
+{
+    if ( k < nblocks ) {
+        for ( std::size_t i = 0; i < B; ++i ) {
+            t = btree_build<B>(keys, n, nblocks, t, k * (B + 1) + i + 1, tree, ranks);
+            tree[k * B + i] = (t < n) ? *(keys + t) : static_cast<K>(std::numeric_limits<key_int_t<K>>::max());
+            ranks[k * B + i] = static_cast<Index>((t < n) ? t++ : n);
+        }
+        t = btree_build<B>(keys, n, nblocks, t, k * (B + 1) + B + 1, tree, ranks);
+    }
+    return t;
+}
+
+// returns the index of the first key not less than `k`, or `n`. the visited nodes are added to `levels`.
+template<std::size_t B, typename K, typename Index>
+inline std::size_t btree_lower_bound(
+     const K *tree
+    ,const Index *ranks
+    ,std::size_t n
+    ,std::size_t nblocks
+    ,const K &k
+    ,std::size_t *levels = nullptr) noexcept
+{
+    std::size_t res = n;
+    std::size_t node = 0;
+    while ( node < nblocks ) {
+        const std::size_t i = simd_count_less<B>(tree + node * B, k);
+        if ( i < B ) {
+            res = ranks[node * B + i];
+        }
+        node = node * (B + 1) + i + 1;
+        if ( levels ) {
+            ++*levels;
+        }
+    }
+
+    return res;
+}
+
+// structure-of-arrays: the lookup touches the keys only, the value is read once at the end.
+template<
+     std::size_t N
+    ,typename T
+    ,typename CmpLess = std::less<T>
+>
+struct soa_storage {
+public:
+    using key_compare = key_compare_t<CmpLess, T>;
+
+private:
+    static_assert(N > 0, "soa_storage requires at least one key");
+    using key_type = typename T::first_type;
+    using mapped_type = typename T::second_type;
+    using index_type = index_type_t<N>;
+
+    // the integral keys are searched with the SIMD compare over the all keys while they
+    // are fitting into four cache lines, and with the 16-wide S-tree otherwise.
+    enum search_kind { binary, linear, kary };
+    static constexpr std::size_t B = 16;
+    static constexpr search_kind kind = (!is_simd_key_v<key_type> || !is_natural_order_v<CmpLess, T>)
+        ? binary
+        : (N * sizeof(key_type) <= 256) ? linear : kary
+    ;
+    static constexpr std::size_t nblocks = (kind == kary) ? (N + B - 1) / B : 0;
+
+    std::array<key_type, N> m_keys;
+    std::array<mapped_type, N> m_values;
+    std::array<key_type, nblocks * B> m_tree;
+    std::array<index_type, nblocks * B> m_ranks;
+
+public:
+    template<typename ...U>
+    constexpr soa_storage(U ...elems)
+        :m_keys{}
+        ,m_values{}
+        ,m_tree{}
+        ,m_ranks{}
+    {
+        const sorted_vector<N, T, CmpLess> vec{std::move(elems)...};
+        for ( std::size_t i = 0; i < N; ++i ) {
+            m_keys[i] = vec[i].first;
+            m_values[i] = vec[i].second;
+        }
+        if constexpr ( kind == kary ) {
+            btree_build<B>(m_keys.data(), N, nblocks, 0, 0, m_tree.data(), m_ranks.data());
+        }
+    }
+
+    constexpr auto size () const noexcept { return N; }
+    constexpr auto begin() const noexcept { return index_iterator<soa_storage>{this, 0}; }
+    constexpr auto end  () const noexcept { return index_iterator<soa_storage>{this, N}; }
+
+    constexpr std::pair<const key_type &, const mapped_type &> operator[](std::size_t i) const noexcept
+    { return {m_keys[i], m_values[i]}; }
+
+    constexpr const auto& keys  () const noexcept { return m_keys; }
+    constexpr const auto& values() const noexcept { return m_values; }
+
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &k) const noexcept {
+        if constexpr ( kind != binary && std::is_same<Key, key_type>::value ) {
+            if ( !is_constant_evaluated() ) {
+                if constexpr ( kind == linear ) {
+                    return simd_linear_find(m_keys.data(), N, k);
+                } else {
+                    const std::size_t idx = btree_lower_bound<B>(m_tree.data(), m_ranks.data(), N, nblocks, k);
+                    return (idx != N && m_keys[idx] == k) ? idx : N;
+                }
+            }
+        }
+
+        return details::find_index(m_keys.data(), N, k, key_compare{});
+    }
+
+    // the scan probes the keys up to the found one, the tree probes one block of `B` keys per level
+    template<typename Key>
+    constexpr std::size_t find_index_probes(const Key &k, std::size_t &probes) const noexcept {
+        if constexpr ( kind != binary && std::is_same<Key, key_type>::value ) {
+            if ( !is_constant_evaluated() ) {
+                if constexpr ( kind == linear ) {
+                    const std::size_t idx = simd_linear_find(m_keys.data(), N, k);
+                    probes += (idx != N) ? idx + 1 : N;
+                    return idx;
+                } else {
+                    const std::size_t idx = btree_lower_bound<B>(m_tree.data(), m_ranks.data(), N, nblocks, k, &probes);
+                    ++probes;
+                    return (idx != N && m_keys[idx] == k) ? idx : N;
+                }
+            }
+        }
+
+        return details::find_index(m_keys.data(), N, k, counting_compare<key_compare>{&probes});
+    }
+
+    template<typename Key>
+    constexpr void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept {
+        if constexpr ( kind == binary ) {
+            details::find_index_batch(m_keys.data(), N, keys, count, out, key_compare{});
+        } else {
+            for ( std::size_t i = 0; i < count; ++i ) {
+                out[i] = find_index(keys[i]);
+            }
+        }
+    }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept {
+        if ( r.size() != N ) {
+            return false;
+        }
+        for ( std::size_t i = 0; i < N; ++i ) {
+            if ( !cmp((*this)[i], r[i]) ) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+/*************************************************************************************************/
+
+// the frame of reference compression of the integral keys: the sorted keys are split into the
+// blocks of `B`, each block keeps its first key in full and the others as the `Delta` offsets
+// from it, the values are in a separate array. a lookup is a search over the block bases and then
+// over the deltas of one block, without decoding the others.
+template<
+     std::size_t N
+    ,typename T
+    ,typename CmpLess = std::less<T>
+    ,typename Delta = std::uint16_t
+    ,std::size_t B = 64
+>
+struct compressed_storage {
+public:
+    using key_compare = std::less<>;
+
+private:
+    static_assert(N > 0, "compressed_storage requires at least one key");
+    static_assert(is_natural_order_v<CmpLess, T>, "compressed_storage requires the natural order of the keys");
+    static_assert(std::is_integral<key_type_t<T>>::value || std::is_enum<key_type_t<T>>::value
+        ,"compressed_storage requires the integral or enum keys");
+    static_assert(std::is_unsigned<Delta>::value, "compressed_storage requires an unsigned Delta");
+    static_assert(B > 0, "compressed_storage requires non-empty blocks");
+
+    using key_type = typename T::first_type;
+    using mapped_type = typename T::second_type;
+
+    static constexpr std::size_t nblocks = (N + B - 1) / B;
+
+    std::array<key_type, nblocks> m_bases;
+    std::array<Delta, N> m_deltas;
+    std::array<mapped_type, N> m_values;
+
+    template<typename Sorted>
+    constexpr void encode(const Sorted &sorted) {
+        for ( std::size_t i = 0; i < N; ++i ) {
+            if ( i % B == 0 ) {
+                m_bases[i / B] = sorted[i].first;
+            }
+            const std::uint64_t delta = key_bits(sorted[i].first) - key_bits(m_bases[i / B]);
+            if ( delta > std::numeric_limits<Delta>::max() ) {
+                throw std::invalid_argument("ctmap: the key deltas of a block are not fitting into Delta");
+            }
+            m_deltas[i] = static_cast<Delta>(delta);
+            m_values[i] = sorted[i].second;
+        }
+    }
+
+public:
+    constexpr compressed_storage(std::array<T, N> arr)
+        :m_bases{}
+        ,m_deltas{}
+        ,m_values{}
+    {
+        encode(sorted_vector<N, T, CmpLess>{std::move(arr)});
+    }
+    // nothing is copied, this one is for the big tables built at runtime
+    constexpr compressed_storage(presorted_t, const std::array<T, N> &arr)
+        :m_bases{}
+        ,m_deltas{}
+        ,m_values{}
+    {
+        for ( std::size_t i = 1; i < N; ++i ) {
+            if ( !(arr[i - 1].first < arr[i].first) ) {
+                throw std::invalid_argument(arr[i - 1].first == arr[i].first
+                    ? "ctmap: duplicate keys"
+                    : "ctmap: the presorted elements are not sorted"
+                );
+            }
+        }
+        encode(arr);
+    }
+
+    constexpr auto size () const noexcept { return N; }
+    constexpr auto begin() const noexcept { return index_iterator<compressed_storage>{this, 0}; }
+    constexpr auto end  () const noexcept { return index_iterator<compressed_storage>{this, N}; }
+
+    constexpr std::pair<key_type, const mapped_type &> operator[](std::size_t i) const noexcept {
+        const std::uint64_t bits = key_bits(m_bases[i / B]) + m_deltas[i];
+        return {static_cast<key_type>(static_cast<key_int_t<key_type>>(bits)), m_values[i]};
+    }
+
+    constexpr const auto& values() const noexcept { return m_values; }
+
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &k) const noexcept {
+        // the last block which base is not greater than the key
+        const std::size_t block = upper_bound_index(m_bases.data(), nblocks, k);
+        if ( block == 0 ) {
+            return N;
+        }
+        const std::size_t first = (block - 1) * B;
+        const std::uint64_t delta = key_bits(k) - key_bits(m_bases[block - 1]);
+        if ( delta > std::numeric_limits<Delta>::max() ) {
+            return N;
+        }
+
+        const std::size_t n = (N - first < B) ? N - first : B;
+        const Delta d = static_cast<Delta>(delta);
+        const std::size_t idx = first + lower_bound_index(m_deltas.data() + first, n, d);
+        return (idx != first + n && m_deltas[idx] == d) ? idx : N;
+    }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept {
+        if ( r.size() != N ) {
+            return false;
+        }
+        for ( std::size_t i = 0; i < N; ++i ) {
+            if ( !cmp((*this)[i], r[i]) ) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+/*************************************************************************************************/
+
+// many keys are sharing a few values, e.g. the aliases of the same handler: the distinct values
+// are kept once, and every key has the smallest sufficient index into them. `D` is the maximum of
+// the distinct values, `make_dedup_map()` computes it from the table.
+template<
+     std::size_t N
+    ,typename T
+    ,typename CmpLess = std::less<T>
+    ,std::size_t D = N
+>
+struct dedup_storage {
+public:
+    using key_compare = key_compare_t<CmpLess, T>;
+
+private:
+    using key_type = typename T::first_type;
+    using mapped_type = typename T::second_type;
+    using index_type = index_type_t<D>;
+
+    std::array<key_type, N> m_keys;
+    std::array<index_type, N> m_index;
+    std::array<mapped_type, D> m_values;
+    std::size_t m_distinct;
+
+public:
+    constexpr dedup_storage(std::array<T, N> arr)
+        :m_keys{}
+        ,m_index{}
+        ,m_values{}
+        ,m_distinct{}
+    {
+        const sorted_vector<N, T, CmpLess> vec{std::move(arr)};
+        for ( std::size_t i = 0; i < N; ++i ) {
+            std::size_t v = 0;
+            while ( v < m_distinct && !(m_values[v] == vec[i].second) ) {
+                ++v;
+            }
+            if ( v == m_distinct ) {
+                if ( m_distinct == D ) {
+                    throw std::invalid_argument("ctmap: more distinct values than D");
+                }
+                m_values[m_distinct++] = vec[i].second;
+            }
+            m_keys[i] = vec[i].first;
+            m_index[i] = static_cast<index_type>(v);
+        }
+    }
+
+    constexpr auto size () const noexcept { return N; }
+    constexpr auto begin() const noexcept { return index_iterator<dedup_storage>{this, 0}; }
+    constexpr auto end  () const noexcept { return index_iterator<dedup_storage>{this, N}; }
+
+    constexpr std::pair<const key_type &, const mapped_type &> operator[](std::size_t i) const noexcept
+    { return {m_keys[i], m_values[m_index[i]]}; }
+
+    // the distinct values, in the order of their first keys
+    constexpr std::size_t distinct() const noexcept { return m_distinct; }
+    constexpr const mapped_type* values() const noexcept { return m_values.data(); }
+
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &k) const noexcept
+    { return details::find_index(m_keys.data(), N, k, key_compare{}); }
+
+    template<typename Key>
+    constexpr void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept
+    { details::find_index_batch(m_keys.data(), N, keys, count, out, key_compare{}); }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept {
+        if ( r.size() != N ) {
+            return false;
+        }
+        for ( std::size_t i = 0; i < N; ++i ) {
+            if ( !cmp((*this)[i], r[i]) ) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+template<typename K, typename V, std::size_t N>
+constexpr std::size_t count_distinct_values(const std::array<std::pair<K, V>, N> &arr) noexcept {
+    std::size_t count = 0;
+    for ( std::size_t i = 0; i < N; ++i ) {
+        std::size_t j = 0;
+        while ( j < i && !(arr[j].second == arr[i].second) ) {
+            ++j;
+        }
+        count += (j == i);
+    }
+
+    return count;
+}
+
+/*************************************************************************************************/
+
+// keeps the duplicate keys in the definition order, the keys and the values are in the separate
+// arrays, so all the values of a key are a contiguous range.
+template<
+     std::size_t N
+    ,typename T
+    ,typename CmpLess = std::less<T>
+>
+struct multi_storage {
+public:
+    using key_compare = key_compare_t<CmpLess, T>;
+
+private:
+    using key_type = typename T::first_type;
+    using mapped_type = typename T::second_type;
+
+    std::array<key_type, N> m_keys;
+    std::array<mapped_type, N> m_values;
+
+public:
+    constexpr multi_storage(std::array<T, N> arr)
+        :m_keys{}
+        ,m_values{}
+    {
+        stable_sort(arr, CmpLess{});
+        for ( std::size_t i = 0; i < N; ++i ) {
+            m_keys[i] = arr[i].first;
+            m_values[i] = arr[i].second;
+        }
+    }
+
+    template<typename ...U>
+    constexpr multi_storage(U ...elems)
+        :multi_storage{std::array<T, N>{std::move(elems)...}}
+    {}
+
+    constexpr auto size () const noexcept { return N; }
+    constexpr auto begin() const noexcept { return index_iterator<multi_storage>{this, 0}; }
+    constexpr auto end  () const noexcept { return index_iterator<multi_storage>{this, N}; }
+
+    constexpr std::pair<const key_type &, const mapped_type &> operator[](std::size_t i) const noexcept
+    { return {m_keys[i], m_values[i]}; }
+
+    constexpr const auto& keys  () const noexcept { return m_keys; }
+    constexpr const auto& values() const noexcept { return m_values; }
+
+    // the first of the equal keys
+    template<typename Key>
+    constexpr std::size_t find_index(const Key &k) const noexcept
+    { return details::find_index(m_keys.data(), N, k, key_compare{}); }
+
+    template<typename Key>
+    constexpr void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept
+    { details::find_index_batch(m_keys.data(), N, keys, count, out, key_compare{}); }
+
+    template<typename Key>
+    constexpr std::pair<std::size_t, std::size_t> equal_range_index(const Key &k) const noexcept {
+        const std::size_t first = lower_bound_index(m_keys.data(), N, k, key_compare{});
+        std::size_t last = first;
+        while ( last != N && !key_compare{}(k, m_keys[last]) ) {
+            ++last;
+        }
+        return {first, last};
+    }
+
+    template<typename RStorage, typename CmpEqual>
+    constexpr bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept {
+        if ( r.size() != N ) {
+            return false;
+        }
+        for ( std::size_t i = 0; i < N; ++i ) {
+            if ( !cmp((*this)[i], r[i]) ) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+} // ns details
+
+/*************************************************************************************************/
+
+template<typename T>
+using optional_t = std::pair<bool, T>;
+
+// a contiguous range of elements
+template<typename T>
+struct span {
+    T *first;
+    T *last;
+
+    constexpr T* begin() const noexcept { return first; }
+    constexpr T* end  () const noexcept { return last; }
+    constexpr std::size_t size() const noexcept { return static_cast<std::size_t>(last - first); }
+    constexpr bool empty() const noexcept { return first == last; }
+    constexpr T& operator[](std::size_t i) const noexcept { return first[i]; }
+};
+
+// the lookup statistics policy of the maps, `ctmap/stats.hpp` has the counting one.
+// `record<Map>()` must not throw, it's called for every key lookup out of the constant evaluation, with the index
+// of the found entry (`size` on a miss) and the number of the probes the lookup took for the key:
+// the key compares, or the blocks of the keys compared at once. the storages which aren't
+// counting them are reporting 0.
+struct no_stats {
+    template<typename Map>
+    static constexpr void record(std::size_t /*idx*/, std::size_t /*size*/, std::size_t /*probes*/) noexcept {}
+};
+
+// the read-only lookup interface over a storage, shared by `map` and `frozen_map`.
+// the storage reports a miss by returning its `size()` from `find_index()`.
+template<typename K, typename V, typename Storage, typename Stats = no_stats>
+struct basic_map {
+    using key_compare = details::storage_key_compare_t<Storage>;
+
+    template<typename... Ts>
+    constexpr basic_map(Ts && ...ts)
+        :vec{std::forward<Ts>(ts)...}
+    {}
+
+    constexpr auto  begin() const noexcept { return vec.begin(); }
+    constexpr auto  end  () const noexcept { return vec.end  (); }
+    constexpr auto  size () const noexcept { return vec.size();  }
+    constexpr const auto& storage() const noexcept { return vec; }
+
+    // the lookups are searching with the key comparator of the storage, see `lookup_key_t`
+    template<typename Key>
+    using lookup_t = details::lookup_key_t<key_compare, K, Key>;
+
+    template<typename Key = K>
+    constexpr optional_t<V> find(const Key &k) const noexcept {
+        const V *p = find_ptr(k);
+        return p ? optional_t<V>{true, *p} : optional_t<V>{false, V{}};
+    }
+    template<typename Key = K>
+    constexpr bool contains(const Key &k) const noexcept
+    { return index_of(static_cast<const lookup_t<Key> &>(k)) != size(); }
+
+    // the zero-copy lookups
+    template<typename Key = K>
+    constexpr const V* find_ptr(const Key &k) const noexcept {
+        const std::size_t idx = index_of(static_cast<const lookup_t<Key> &>(k));
+        return (idx != size()) ? &(vec[idx].second) : nullptr;
+    }
+    template<typename Key = K>
+    constexpr auto find_it(const Key &k) const noexcept
+    { return begin() + index_of(static_cast<const lookup_t<Key> &>(k)); }
+    template<typename Key = K>
+    constexpr const V& at(const Key &k) const {
+        const V *p = find_ptr(k);
+        if ( !p ) {
+            throw std::out_of_range("ctmap::map::at(): key not found");
+        }
+        return *p;
+    }
+
+    // the iterators into the sorted order of the storage
+    template<typename Key = K>
+    constexpr auto lower_bound(const Key &k) const noexcept {
+        return begin() + details::lower_bound_index(
+            begin(), size(), static_cast<const lookup_t<Key> &>(k), key_compare{});
+    }
+    template<typename Key = K>
+    constexpr auto upper_bound(const Key &k) const noexcept {
+        return begin() + details::upper_bound_index(
+            begin(), size(), static_cast<const lookup_t<Key> &>(k), key_compare{});
+    }
+    template<typename Key = K>
+    constexpr auto equal_range(const Key &k) const noexcept
+    { return std::make_pair(lower_bound(k), upper_bound(k)); }
+
+    // looks up `count` keys at once, the searches are interleaved so their memory stalls are overlapping.
+    template<typename Key>
+    constexpr void find_batch(const Key *keys, std::size_t count, optional_t<V> *out) const noexcept {
+        const std::size_t n = size();
+        std::size_t idx[details::batch_group]{};
+        for ( std::size_t i = 0; i < count; i += details::batch_group ) {
+            const std::size_t group = (count - i < details::batch_group) ? count - i : details::batch_group;
+            if constexpr ( std::is_same<lookup_t<Key>, Key>::value ) {
+                find_index_batch(keys + i, group, idx);
+            } else {
+                // the keys are converted the same as by `find()`
+                lookup_t<Key> probes[details::batch_group]{};
+                for ( std::size_t j = 0; j < group; ++j ) {
+                    probes[j] = static_cast<lookup_t<Key>>(keys[i + j]);
+                }
+                find_index_batch(probes, group, idx);
+            }
+            // the std::pair assignment is not constexpr in C++17
+            for ( std::size_t j = 0; j < group; ++j ) {
+                out[i + j].first = (idx[j] != n);
+                out[i + j].second = (idx[j] != n) ? vec[idx[j]].second : V{};
+            }
+        }
+    }
+    // the both spans are of the same size
+    constexpr void find_batch(span<const K> keys, span<optional_t<V>> out) const {
+        if ( keys.size() != out.size() ) {
+            throw std::length_error("ctmap::map::find_batch(): the keys and the results are of different sizes");
+        }
+        find_batch(keys.begin(), keys.size(), out.begin());
+    }
+    template<typename InputIt, typename OutputIt>
+    constexpr OutputIt find_batch(InputIt first, InputIt last, OutputIt out) const {
+        typename std::iterator_traits<InputIt>::value_type keys[details::batch_group]{};
+        optional_t<V> res[details::batch_group]{};
+        while ( first != last ) {
+            std::size_t count = 0;
+            for ( ; count < details::batch_group && first != last; ++count, ++first ) {
+                keys[count] = *first;
+            }
+            find_batch(keys, count, res);
+            for ( std::size_t j = 0; j < count; ++j, ++out ) {
+                *out = res[j];
+            }
+        }
+        return out;
+    }
+
+    constexpr decltype(auto) operator[](std::size_t i) const noexcept { return vec[i]; }
+
+private:
+    // the counted lookups are the same searches, counting their probes on the way
+    template<typename Key>
+    constexpr std::size_t index_of(const Key &k) const noexcept {
+        if constexpr ( !std::is_same<Stats, no_stats>::value ) {
+            if ( !details::is_constant_evaluated() ) {
+                std::size_t probes = 0;
+                const std::size_t idx = find_index_probes(k, probes);
+                Stats::template record<basic_map>(idx, size(), probes);
+
+                return idx;
+            }
+        }
+
+        return vec.find_index(k);
+    }
+    template<typename Key>
+    constexpr std::size_t find_index_probes(const Key &k, std::size_t &probes) const noexcept {
+        if constexpr ( details::has_find_index_probes<Storage, Key>::value ) {
+            return vec.find_index_probes(k, probes);
+        } else {
+            return vec.find_index(k);
+        }
+    }
+
+    template<typename Key>
+    constexpr void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept {
+        if constexpr ( !std::is_same<Stats, no_stats>::value ) {
+            // the probes are counted per key, so the counted lookups are not interleaved
+            if ( !details::is_constant_evaluated() ) {
+                for ( std::size_t i = 0; i < count; ++i ) {
+                    out[i] = index_of(keys[i]);
+                }
+                return;
+            }
+        }
+        if constexpr ( details::has_find_index_batch<Storage, Key>::value ) {
+            vec.find_index_batch(keys, count, out);
+        } else {
+            for ( std::size_t i = 0; i < count; ++i ) {
+                out[i] = vec.find_index(keys[i]);
+            }
+        }
+    }
+
+protected:
+    Storage vec;
+};
+
+template<
+     std::size_t N
+    ,typename K
+    ,typename V
+    ,typename CmpLess = std::less<std::pair<K, V>>
+    ,typename Storage = details::sorted_vector<N, std::pair<K, V>, CmpLess>
+    ,typename Stats = no_stats
+>
+struct map: basic_map<K, V, Storage, Stats> {
+    using basic_map<K, V, Storage, Stats>::basic_map;
+
+    template<std::size_t NN, typename RCmpLess, typename RStorage, typename RStats, typename CmpEqual>
+    constexpr bool equal(const map<NN, K, V, RCmpLess, RStorage, RStats> &r, const CmpEqual &cmp) const noexcept {
+        if constexpr ( N != NN ) {
+            return false;
+        } else {
+            return this->vec.equal(r.storage(), cmp);
+        }
+    }
+};
+
+// the same map with the lookup statistics policy `Stats`:
+//   static constexpr auto m = ctmap::with_stats<ctmap::counting_stats<tag>>(ctmap::make_map(...));
+template<typename Stats, std::size_t N, typename K, typename V, typename CmpLess, typename Storage, typename S>
+constexpr auto with_stats(const map<N, K, V, CmpLess, Storage, S> &m) {
+    return map<N, K, V, CmpLess, Storage, Stats>{m.storage()};
+}
+
+/***********************************************************************************/
+
+namespace details {
+
+// the map type picked by `make_map()`, an empty map is always a `sorted_vector`
+template<std::size_t N, typename K, typename V>
+using default_map_t = map<N, K, V, less_key<std::pair<K, V>>, std::conditional_t<
+     (std::is_integral<K>::value || std::is_enum<K>::value) && N != 0
+    ,dense_storage<N, std::pair<K, V>, less_key<std::pair<K, V>>>
+    ,sorted_vector<N, std::pair<K, V>, less_key<std::pair<K, V>>>
+>>;
+
+// the std::to_array() is C++20, and it is a pack expansion which the array overloads are avoiding
+template<typename K, typename V, std::size_t N>
+constexpr std::array<std::pair<K, V>, N> to_array(const std::pair<K, V> (&arr)[N]) {
+    std::array<std::pair<K, V>, N> res{};
+    for ( std::size_t i = 0; i < N; ++i ) {
+        res[i].first = arr[i].first;
+        res[i].second = arr[i].second;
+    }
+
+    return res;
+}
+
+} // ns details
+
+template<typename K, typename V, template<typename, typename> class ...Pairs>
+constexpr auto make_map(Pairs<K, V> && ...ts) {
+    return details::default_map_t<sizeof...(Pairs), K, V>{std::forward<Pairs<K, V>>(ts)...};
+}
+
+// the array overloads are compiling in the linear time and memory, without the huge parameter packs
+template<typename K, typename V, std::size_t N>
+constexpr auto make_map(const std::array<std::pair<K, V>, N> &arr) {
+    return details::default_map_t<N, K, V>{arr};
+}
+
+template<typename K, typename V, std::size_t N>
+constexpr auto make_map(const std::pair<K, V> (&arr)[N]) {
+    return details::default_map_t<N, K, V>{details::to_array(arr)};
+}
+
+// the array is not sorted, only its order is verified
+template<typename K, typename V, std::size_t N>
+constexpr auto make_map(presorted_t, const std::array<std::pair<K, V>, N> &arr) {
+    return details::default_map_t<N, K, V>{presorted, arr};
+}
+
+template<typename K, typename V, std::size_t N>
+constexpr auto make_map(presorted_t, const std::pair<K, V> (&arr)[N]) {
+    return details::default_map_t<N, K, V>{presorted, details::to_array(arr)};
 }
 
 template<typename CmpLess, typename K, typename V, template<typename, typename> class ...Pairs>
@@ -324,8 +2722,606 @@ constexpr auto make_map_cmp(CmpLess, Pairs<K, V> && ...ts) {
     return map<sizeof...(Pairs), K, V, CmpLess>{std::forward<Pairs<K, V>>(ts)...};
 }
 
+template<typename CmpLess, typename K, typename V, std::size_t N>
+constexpr auto make_map_cmp(CmpLess, const std::array<std::pair<K, V>, N> &arr) {
+    return map<N, K, V, CmpLess>{arr};
+}
+
+template<typename CmpLess, typename K, typename V, std::size_t N>
+constexpr auto make_map_cmp(CmpLess, const std::pair<K, V> (&arr)[N]) {
+    return map<N, K, V, CmpLess>{details::to_array(arr)};
+}
+
+template<typename CmpLess, typename K, typename V, std::size_t N>
+constexpr auto make_map_cmp(CmpLess, presorted_t, const std::array<std::pair<K, V>, N> &arr) {
+    return map<N, K, V, CmpLess>{presorted, arr};
+}
+
+/*************************************************************************************************/
+
+template<
+     std::size_t N
+    ,typename K
+    ,typename V
+    ,typename CmpLess = details::less_key<std::pair<K, V>>
+    ,typename Hash = details::hash<K>
+>
+using unordered_map = map<N, K, V, CmpLess, details::pmh_storage<N, std::pair<K, V>, CmpLess, Hash>>;
+
+template<typename K, typename V, template<typename, typename> class ...Pairs>
+constexpr auto make_unordered_map(Pairs<K, V> && ...ts) {
+    return unordered_map<sizeof...(Pairs), K, V>{std::forward<Pairs<K, V>>(ts)...};
+}
+
+template<typename K, typename V, std::size_t N>
+constexpr auto make_unordered_map(const std::array<std::pair<K, V>, N> &arr) {
+    return unordered_map<N, K, V>{arr};
+}
+
+template<typename Hash, typename CmpLess, typename K, typename V, template<typename, typename> class ...Pairs>
+constexpr auto make_unordered_map_cmp(Hash, CmpLess, Pairs<K, V> && ...ts) {
+    return unordered_map<sizeof...(Pairs), K, V, CmpLess, Hash>{std::forward<Pairs<K, V>>(ts)...};
+}
+
+/*************************************************************************************************/
+
+template<
+     std::size_t N
+    ,typename K
+    ,typename V
+    ,typename CmpLess = details::less_key<std::pair<K, V>>
+>
+using eytzinger_map = map<N, K, V, CmpLess, details::eytzinger_storage<N, std::pair<K, V>, CmpLess>>;
+
+template<typename K, typename V, template<typename, typename> class ...Pairs>
+constexpr auto make_eytzinger_map(Pairs<K, V> && ...ts) {
+    return eytzinger_map<sizeof...(Pairs), K, V>{std::forward<Pairs<K, V>>(ts)...};
+}
+
+template<typename K, typename V, std::size_t N>
+constexpr auto make_eytzinger_map(const std::array<std::pair<K, V>, N> &arr) {
+    return eytzinger_map<N, K, V>{arr};
+}
+
+/*************************************************************************************************/
+
+template<
+     std::size_t N
+    ,typename K
+    ,typename V
+    ,std::size_t H = 4
+    ,typename CmpLess = details::less_key<std::pair<K, V>>
+>
+using weighted_map = map<N, K, V, CmpLess, details::weighted_storage<N, std::pair<K, V>, CmpLess, H>>;
+
+// the weights are the expected access frequencies of the entries, e.g. the hits of `get_stats()`.
+// `H` is the most of the hot keys compared before the search.
+template<std::size_t H = 4, typename K, typename V, std::size_t N>
+constexpr auto make_weighted_map(const std::array<std::pair<K, V>, N> &arr, const std::array<std::uint64_t, N> &weights) {
+    return weighted_map<N, K, V, H>{arr, weights};
+}
+
+template<std::size_t H = 4, std::size_t N, typename K, typename V, template<typename, typename> class ...Pairs>
+constexpr auto make_weighted_map(const std::uint64_t (&weights)[N], Pairs<K, V> && ...ts) {
+    static_assert(N == sizeof...(Pairs), "ctmap: the number of the weights differs from the number of the entries");
+
+    std::array<std::uint64_t, N> warr{};
+    for ( std::size_t i = 0; i < N; ++i ) {
+        warr[i] = weights[i];
+    }
+    return weighted_map<N, K, V, H>{std::array<std::pair<K, V>, N>{std::forward<Pairs<K, V>>(ts)...}, warr};
+}
+
+/*************************************************************************************************/
+
+template<
+     std::size_t N
+    ,typename K
+    ,typename V
+    ,typename CmpLess = details::less_key<std::pair<K, V>>
+>
+using soa_map = map<N, K, V, CmpLess, details::soa_storage<N, std::pair<K, V>, CmpLess>>;
+
+template<typename K, typename V, template<typename, typename> class ...Pairs>
+constexpr auto make_soa_map(Pairs<K, V> && ...ts) {
+    return soa_map<sizeof...(Pairs), K, V>{std::forward<Pairs<K, V>>(ts)...};
+}
+
+template<typename K, typename V, std::size_t N>
+constexpr auto make_soa_map(const std::array<std::pair<K, V>, N> &arr) {
+    return soa_map<N, K, V>{arr};
+}
+
+/*************************************************************************************************/
+
+template<
+     std::size_t N
+    ,typename K
+    ,typename V
+    ,typename Delta = std::uint16_t
+    ,std::size_t B = 64
+    ,typename CmpLess = details::less_key<std::pair<K, V>>
+>
+using compressed_map = map<N, K, V, CmpLess, details::compressed_storage<N, std::pair<K, V>, CmpLess, Delta, B>>;
+
+// `Delta` must hold the distance between the first and the last key of every block of `B` keys,
+// a bigger block is a smaller search index but a longer search inside a block.
+template<typename Delta = std::uint16_t, std::size_t B = 64, typename K, typename V, template<typename, typename> class ...Pairs>
+constexpr auto make_compressed_map(Pairs<K, V> && ...ts) {
+    return compressed_map<sizeof...(Pairs), K, V, Delta, B>{
+        std::array<std::pair<K, V>, sizeof...(Pairs)>{std::forward<Pairs<K, V>>(ts)...}
+    };
+}
+
+template<typename Delta = std::uint16_t, std::size_t B = 64, typename K, typename V, std::size_t N>
+constexpr auto make_compressed_map(const std::array<std::pair<K, V>, N> &arr) {
+    return compressed_map<N, K, V, Delta, B>{arr};
+}
+
+template<typename Delta = std::uint16_t, std::size_t B = 64, typename K, typename V, std::size_t N>
+constexpr auto make_compressed_map(presorted_t, const std::array<std::pair<K, V>, N> &arr) {
+    return compressed_map<N, K, V, Delta, B>{presorted, arr};
+}
+
+/*************************************************************************************************/
+
+template<
+     std::size_t N
+    ,typename K
+    ,typename V
+    ,std::size_t D = N
+    ,typename CmpLess = details::less_key<std::pair<K, V>>
+>
+using dedup_map = map<N, K, V, CmpLess, details::dedup_storage<N, std::pair<K, V>, CmpLess, D>>;
+
+// the table is a template argument, so the number of its distinct values is a constant:
+//   static constexpr std::array<std::pair<std::string_view, handler>, 5> table{...};
+//   static constexpr auto m = ctmap::make_dedup_map<table>();
+template<const auto &Arr>
+constexpr auto make_dedup_map() {
+    using pair_type = typename std::decay_t<decltype(Arr)>::value_type;
+    using K = typename pair_type::first_type;
+    using V = typename pair_type::second_type;
+
+    return dedup_map<Arr.size(), K, V, details::count_distinct_values(Arr)>{Arr};
+}
+
+/*************************************************************************************************/
+
+template<
+     std::size_t N
+    ,typename V
+    ,typename CmpLess = details::less_key<std::pair<std::string_view, V>>
+>
+using string_map = map<N, std::string_view, V, CmpLess, details::string_storage<N, std::pair<std::string_view, V>, CmpLess>>;
+
+template<typename V, template<typename, typename> class ...Pairs>
+constexpr auto make_string_map(Pairs<std::string_view, V> && ...ts) {
+    return string_map<sizeof...(Pairs), V>{std::forward<Pairs<std::string_view, V>>(ts)...};
+}
+
+template<typename V, std::size_t N>
+constexpr auto make_string_map(const std::array<std::pair<std::string_view, V>, N> &arr) {
+    return string_map<N, V>{arr};
+}
+
+/*************************************************************************************************/
+
+template<
+     std::size_t N
+    ,typename V
+    ,typename CmpLess = details::less_key<std::pair<std::string_view, V>>
+>
+using trie_map = map<N, std::string_view, V, CmpLess, details::trie_storage<N, std::pair<std::string_view, V>, CmpLess>>;
+
+template<typename V, template<typename, typename> class ...Pairs>
+constexpr auto make_trie_map(Pairs<std::string_view, V> && ...ts) {
+    return trie_map<sizeof...(Pairs), V>{std::forward<Pairs<std::string_view, V>>(ts)...};
+}
+
+template<typename V, std::size_t N>
+constexpr auto make_trie_map(const std::array<std::pair<std::string_view, V>, N> &arr) {
+    return trie_map<N, V>{arr};
+}
+
+/*************************************************************************************************/
+
+// allows the duplicate keys: `find()` returns the first value defined for the key,
+// and `equal_range()` all of them, in the definition order.
+template<
+     std::size_t N
+    ,typename K
+    ,typename V
+    ,typename CmpLess = details::less_key<std::pair<K, V>>
+>
+struct multimap: basic_map<K, V, details::multi_storage<N, std::pair<K, V>, CmpLess>> {
+    using basic_map<K, V, details::multi_storage<N, std::pair<K, V>, CmpLess>>::basic_map;
+
+    template<typename Key = K>
+    constexpr span<const V> equal_range(const Key &k) const noexcept {
+        using lookup_type = typename basic_map<K, V, details::multi_storage<N, std::pair<K, V>, CmpLess>>::template lookup_t<Key>;
+        const auto r = this->vec.equal_range_index(static_cast<const lookup_type &>(k));
+        const V *values = this->vec.values().data();
+        return {values + r.first, values + r.second};
+    }
+    template<typename Key = K>
+    constexpr std::size_t count(const Key &k) const noexcept { return equal_range(k).size(); }
+};
+
+template<typename K, typename V, template<typename, typename> class ...Pairs>
+constexpr auto make_multimap(Pairs<K, V> && ...ts) {
+    return multimap<sizeof...(Pairs), K, V>{std::forward<Pairs<K, V>>(ts)...};
+}
+
+template<typename K, typename V, std::size_t N>
+constexpr auto make_multimap(const std::array<std::pair<K, V>, N> &arr) {
+    return multimap<N, K, V>{arr};
+}
+
+/*************************************************************************************************/
+
+// maps the non-overlapping half-open ranges `[lo, hi)` to the values, `find()` looks up the range
+// containing a point. the lookup is the predecessor search over the lower bounds, with the same
+// kernels as `soa_storage`: the SIMD scan for the small tables, the S-tree for the big ones.
+//   static constexpr auto ports = ctmap::make_interval_map(
+//        std::make_pair(std::make_pair(0, 1024), port_class::system)
+//       ,std::make_pair(std::make_pair(1024, 49152), port_class::registered)
+//   );
+template<std::size_t N, typename K, typename V>
+struct interval_map {
+    using range_type = std::pair<K, K>;
+    using value_type = std::pair<range_type, V>;
+
+private:
+    using index_type = details::index_type_t<N>;
+
+    enum search_kind { binary, linear, kary };
+    static constexpr std::size_t B = 16;
+    // the linear scan counts over the whole blocks, the padding keys are the maximal ones
+    static constexpr std::size_t padded = (N + B - 1) / B * B;
+    static constexpr search_kind kind = !details::is_simd_key_v<K>
+        ? binary
+        : (padded * sizeof(K) <= 256) ? linear : kary
+    ;
+    static constexpr std::size_t nlo = (kind == linear) ? padded : N;
+    static constexpr std::size_t nblocks = (kind == kary) ? (N + B - 1) / B : 0;
+
+    std::array<K, nlo> m_lo;
+    std::array<K, N> m_hi;
+    std::array<V, N> m_values;
+    std::array<K, nblocks * B> m_tree;
+    std::array<index_type, nblocks * B> m_ranks;
+
+public:
+    constexpr interval_map(std::array<value_type, N> arr)
+        :m_lo{}
+        ,m_hi{}
+        ,m_values{}
+        ,m_tree{}
+        ,m_ranks{}
+    {
+        details::sort(arr.begin(), arr.end()
+            ,[](const value_type &l, const value_type &r) { return l.first.first < r.first.first; }
+        );
+        for ( std::size_t i = 0; i < N; ++i ) {
+            if ( !(arr[i].first.first < arr[i].first.second) ) {
+                throw std::invalid_argument("ctmap: an empty interval");
+            }
+            if ( i && arr[i].first.first < arr[i - 1].first.second ) {
+                throw std::invalid_argument("ctmap: overlapping intervals");
+            }
+            m_lo[i] = arr[i].first.first;
+            m_hi[i] = arr[i].first.second;
+            m_values[i] = arr[i].second;
+        }
+        if constexpr ( kind == linear ) {
+            for ( std::size_t i = N; i < nlo; ++i ) {
+                m_lo[i] = static_cast<K>(std::numeric_limits<details::key_int_t<K>>::max());
+            }
+        } else if constexpr ( kind == kary ) {
+            details::btree_build<B>(m_lo.data(), N, nblocks, 0, 0, m_tree.data(), m_ranks.data());
+        }
+    }
+
+    constexpr std::size_t size() const noexcept { return N; }
+    constexpr auto begin() const noexcept { return details::index_iterator<interval_map>{this, 0}; }
+    constexpr auto end  () const noexcept { return details::index_iterator<interval_map>{this, N}; }
+
+    // by the ascending ranges
+    constexpr std::pair<range_type, const V &> operator[](std::size_t i) const noexcept
+    { return {range_type{m_lo[i], m_hi[i]}, m_values[i]}; }
+
+    // the index of the range containing `k`, or `size()`
+    constexpr std::size_t find_index(const K &k) const noexcept {
+        // the ranges starting not after `k`
+        std::size_t i = lower_index(k);
+        i += static_cast<std::size_t>(i < N && !(k < m_lo[i]));
+
+        return (i && k < m_hi[i - 1]) ? i - 1 : N;
+    }
+
+    constexpr optional_t<V> find(const K &k) const noexcept {
+        const std::size_t idx = find_index(k);
+        return (idx != N) ? optional_t<V>{true, m_values[idx]} : optional_t<V>{false, V{}};
+    }
+    constexpr const V* find_ptr(const K &k) const noexcept {
+        const std::size_t idx = find_index(k);
+        return (idx != N) ? &m_values[idx] : nullptr;
+    }
+    constexpr bool contains(const K &k) const noexcept { return find_index(k) != N; }
+    constexpr const V& at(const K &k) const {
+        const V *p = find_ptr(k);
+        if ( !p ) {
+            throw std::out_of_range("ctmap::interval_map::at(): no interval contains the key");
+        }
+        return *p;
+    }
+
+private:
+    // the index of the first lower bound not less than `k`
+    constexpr std::size_t lower_index(const K &k) const noexcept {
+        if constexpr ( kind != binary ) {
+            if ( !details::is_constant_evaluated() ) {
+                if constexpr ( kind == linear ) {
+                    return details::simd_count_less<nlo>(m_lo.data(), k);
+                } else {
+                    return details::btree_lower_bound<B>(m_tree.data(), m_ranks.data(), N, nblocks, k);
+                }
+            }
+        }
+
+        return details::lower_bound_index(m_lo.data(), N, k);
+    }
+};
+
+template<typename K, typename V, template<typename, typename> class ...Pairs>
+constexpr auto make_interval_map(Pairs<std::pair<K, K>, V> && ...ts) {
+    return interval_map<sizeof...(Pairs), K, V>{
+        std::array<std::pair<std::pair<K, K>, V>, sizeof...(Pairs)>{std::forward<Pairs<std::pair<K, K>, V>>(ts)...}
+    };
+}
+
+template<typename K, typename V, std::size_t N>
+constexpr auto make_interval_map(const std::array<std::pair<std::pair<K, K>, V>, N> &arr) {
+    return interval_map<N, K, V>{arr};
+}
+
+/*************************************************************************************************/
+
+// the membership tables: the keys only, without the values
+template<
+     std::size_t N
+    ,typename K
+    ,typename CmpLess = std::less<K>
+    ,typename Storage = details::sorted_vector<N, K, CmpLess>
+>
+struct set {
+    using key_compare = details::storage_key_compare_t<Storage>;
+
+    template<typename Key>
+    using lookup_t = details::lookup_key_t<key_compare, K, Key>;
+
+    template<typename... Ts>
+    constexpr set(Ts && ...ts)
+        :vec{std::forward<Ts>(ts)...}
+    {}
+
+    constexpr auto  begin() const noexcept { return vec.begin(); }
+    constexpr auto  end  () const noexcept { return vec.end  (); }
+    constexpr auto  size () const noexcept { return vec.size();  }
+    constexpr const auto& storage() const noexcept { return vec; }
+
+    template<typename Key = K>
+    constexpr bool contains(const Key &k) const noexcept {
+        if constexpr ( details::has_contains<Storage, lookup_t<Key>>::value ) {
+            return vec.contains(static_cast<const lookup_t<Key> &>(k));
+        } else {
+            return vec.find_index(static_cast<const lookup_t<Key> &>(k)) != size();
+        }
+    }
+    template<typename Key = K>
+    constexpr std::size_t count(const Key &k) const noexcept { return contains(k) ? 1 : 0; }
+    template<typename Key = K>
+    constexpr auto find(const Key &k) const noexcept
+    { return begin() + vec.find_index(static_cast<const lookup_t<Key> &>(k)); }
+
+    template<typename Key = K>
+    constexpr auto lower_bound(const Key &k) const noexcept {
+        return begin() + details::lower_bound_index(
+            begin(), size(), static_cast<const lookup_t<Key> &>(k), key_compare{});
+    }
+    template<typename Key = K>
+    constexpr auto upper_bound(const Key &k) const noexcept {
+        return begin() + details::upper_bound_index(
+            begin(), size(), static_cast<const lookup_t<Key> &>(k), key_compare{});
+    }
+
+    constexpr decltype(auto) operator[](std::size_t i) const noexcept { return vec[i]; }
+
+protected:
+    Storage vec;
+};
+
+template<
+     std::size_t N
+    ,typename K
+    ,typename CmpLess = std::less<K>
+    ,typename Hash = details::hash<K>
+>
+using unordered_set = set<N, K, CmpLess, details::pmh_storage<N, K, CmpLess, Hash>>;
+
+template<
+     std::size_t N
+    ,typename K
+    ,std::size_t Bits = 256
+>
+using bitmask_set = set<N, K, std::less<K>, details::bitmask_storage<N, K, std::less<K>, Bits>>;
+
+template<typename K, typename ...Ks>
+constexpr auto make_set(K k, Ks ...ks) {
+    static_assert((details::is_brace_convertible<K, Ks>::value && ...), "narrowing key conversion");
+    return set<1 + sizeof...(Ks), K>{std::array<K, 1 + sizeof...(Ks)>{k, ks...}};
+}
+
+template<typename K, std::size_t N>
+constexpr auto make_set(const std::array<K, N> &arr) {
+    return set<N, K>{arr};
+}
+
+template<typename K, typename ...Ks>
+constexpr auto make_unordered_set(K k, Ks ...ks) {
+    static_assert((details::is_brace_convertible<K, Ks>::value && ...), "narrowing key conversion");
+    return unordered_set<1 + sizeof...(Ks), K>{std::array<K, 1 + sizeof...(Ks)>{k, ks...}};
+}
+
+template<typename K, std::size_t N>
+constexpr auto make_unordered_set(const std::array<K, N> &arr) {
+    return unordered_set<N, K>{arr};
+}
+
+// the keys must be within `Bits` from the smallest one
+template<std::size_t Bits = 256, typename K, typename ...Ks>
+constexpr auto make_bitmask_set(K k, Ks ...ks) {
+    static_assert((details::is_brace_convertible<K, Ks>::value && ...), "narrowing key conversion");
+    return bitmask_set<1 + sizeof...(Ks), K, Bits>{std::array<K, 1 + sizeof...(Ks)>{k, ks...}};
+}
+
+template<std::size_t Bits = 256, typename K, std::size_t N>
+constexpr auto make_bitmask_set(const std::array<K, N> &arr) {
+    return bitmask_set<N, K, Bits>{arr};
+}
+
+/*************************************************************************************************/
+
+// the maps are rejecting the duplicate keys at the build time, this check allows
+// to `static_assert()` on a table before building a map from it.
+template<typename K, typename V, std::size_t N, typename CmpLess = details::less_key<std::pair<K, V>>>
+constexpr bool has_unique_keys(std::array<std::pair<K, V>, N> arr, CmpLess cmp = CmpLess{}) {
+    details::sort(arr.begin(), arr.end(), cmp);
+    return details::find_duplicate(arr.begin(), N, cmp) == N;
+}
+
 /*************************************************************************************************/
 
+// the compile-time dispatch: the entries of a map with the static storage duration are expanded
+// into a chain of the key comparisons, which the compiler turns into a jump table (the same as
+// a hand-written `switch`), so the handler is called without the search and, when the values are
+// the function pointers known at compile time, without the indirect call. for the sparse keys
+// the storage search finds the entry and a table of the per-entry calls replaces the chain.
+
+namespace details {
+
+template<const auto &M>
+using dispatch_key_t = std::decay_t<decltype(M.storage()[0].first)>;
+
+template<const auto &M, std::size_t I>
+constexpr decltype(auto) dispatch_value() noexcept { return (M.storage()[I].second); }
+
+template<typename T, bool = std::is_enum<T>::value>
+struct dispatch_integral { using type = T; };
+
+template<typename T>
+struct dispatch_integral<T, true> { using type = std::underlying_type_t<T>; };
+
+// the compiler lowers the comparison chain into a jump table only when the keys are dense enough,
+// otherwise it stays a chain of the compares.
+template<const auto &M>
+constexpr bool dispatch_is_dense() noexcept {
+    using integral_type = typename dispatch_integral<dispatch_key_t<M>>::type;
+
+    integral_type min = static_cast<integral_type>(M.storage()[0].first), max = min;
+    for ( std::size_t i = 1; i < M.size(); ++i ) {
+        const auto key = static_cast<integral_type>(M.storage()[i].first);
+        min = (key < min) ? key : min;
+        max = (max < key) ? key : max;
+    }
+    const auto span = static_cast<std::uint64_t>(max) - static_cast<std::uint64_t>(min);
+
+    return M.size() <= 4 || span / 8 < M.size();
+}
+
+template<typename G, std::size_t I>
+constexpr void dispatch_thunk(G &g) { g(std::integral_constant<std::size_t, I>{}); }
+
+template<typename G, std::size_t ...I>
+constexpr void (*const dispatch_table[])(G &) = {&dispatch_thunk<G, I>...};
+
+// calls `g(std::integral_constant<std::size_t, I>{})` for the entry `I` with the key `k`.
+// the sparse keys are searched by the storage, and the entry is called through a table.
+template<const auto &M, typename G, std::size_t ...I>
+constexpr bool dispatch_index(const dispatch_key_t<M> &k, G &g, std::index_sequence<I...>) {
+    static_assert(std::is_integral<dispatch_key_t<M>>::value || std::is_enum<dispatch_key_t<M>>::value
+        ,"ctmap: dispatch() requires the integral or enum keys");
+
+    if constexpr ( dispatch_is_dense<M>() ) {
+        return ((k == M.storage()[I].first && (g(std::integral_constant<std::size_t, I>{}), true)) || ...);
+    } else {
+        const std::size_t idx = M.storage().find_index(k);
+        if ( idx == M.size() ) {
+            return false;
+        }
+        dispatch_table<G, I...>[idx](g);
+
+        return true;
+    }
+}
+
+template<const auto &M, typename R, typename G, typename D>
+constexpr R dispatch_result(const dispatch_key_t<M> &k, G &g, D &def) {
+    constexpr auto seq = std::make_index_sequence<M.size()>{};
+    if constexpr ( std::is_void<R>::value ) {
+        if ( !dispatch_index<M>(k, g, seq) ) {
+            def(k);
+        }
+    } else {
+        R res{};
+        auto call = [&res, &g](auto i) { res = g(i); };
+        return dispatch_index<M>(k, call, seq) ? res : R(def(k));
+    }
+}
+
+template<const auto &M, typename F, typename Tuple, std::size_t ...I>
+auto visit_result(std::index_sequence<I...>) -> std::common_type_t<
+    std::decay_t<decltype(std::declval<F &>()(std::get<dispatch_value<M, I>()>(std::declval<Tuple &>())))>...
+>;
+
+template<const auto &M, typename F, typename Tuple>
+using visit_result_t = decltype(visit_result<M, F, Tuple>(std::make_index_sequence<M.size()>{}));
+
+} // ns details
+
+// calls `f(value)` for the key `k`, returns `false` when the key is not in the map
+template<const auto &M, typename F>
+constexpr bool dispatch(const details::dispatch_key_t<M> &k, F &&f) {
+    auto g = [&f](auto i) { f(details::dispatch_value<M, decltype(i)::value>()); };
+    return details::dispatch_index<M>(k, g, std::make_index_sequence<M.size()>{});
+}
+
+// returns `f(value)` for the key `k`, or `def(k)` when the key is not in the map.
+// a non-void result must be default constructible.
+template<const auto &M, typename F, typename D>
+constexpr auto dispatch(const details::dispatch_key_t<M> &k, F &&f, D &&def) {
+    using R = std::decay_t<decltype(f(details::dispatch_value<M, 0>()))>;
+    auto g = [&f](auto i) -> R { return f(details::dispatch_value<M, decltype(i)::value>()); };
+    return details::dispatch_result<M, R>(k, g, def);
+}
+
+// the heterogeneous values: the map values are the indices into the tuple `t`, and `f` is
+// called with `std::get<value>(t)`, so each entry can have its own type.
+template<const auto &M, typename Tuple, typename F>
+constexpr bool visit(const details::dispatch_key_t<M> &k, Tuple &&t, F &&f) {
+    auto g = [&t, &f](auto i) { f(std::get<details::dispatch_value<M, decltype(i)::value>()>(t)); };
+    return details::dispatch_index<M>(k, g, std::make_index_sequence<M.size()>{});
+}
+
+// returns `f(std::get<value>(t))` converted to the common type of the results, or `def(k)`.
+template<const auto &M, typename Tuple, typename F, typename D>
+constexpr auto visit(const details::dispatch_key_t<M> &k, Tuple &&t, F &&f, D &&def) {
+    using R = details::visit_result_t<M, F, std::remove_reference_t<Tuple>>;
+    auto g = [&t, &f](auto i) -> R { return f(std::get<details::dispatch_value<M, decltype(i)::value>()>(t)); };
+    return details::dispatch_result<M, R>(k, g, def);
+}
+
 } // ns ctmap
 
 /*************************************************************************************************/
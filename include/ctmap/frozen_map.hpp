@@ -0,0 +1,285 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------
+
+#ifndef __CTMAP__FROZEN_MAP_HPP
+#define __CTMAP__FROZEN_MAP_HPP
+
+#include <ctmap/ctmap.hpp>
+
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace ctmap {
+namespace details {
+
+/*************************************************************************************************/
+// the runtime counterparts of the constexpr storages: built once from a range, and are
+// using the same search kernels.
+
+template<typename CharT, typename Traits, typename Alloc>
+struct hash<std::basic_string<CharT, Traits, Alloc>> {
+    // the view is accepting the transparent lookup keys without a copy
+    std::uint64_t operator()(std::basic_string_view<CharT, Traits> k, std::uint64_t seed) const noexcept
+    { return hash<std::basic_string_view<CharT, Traits>>{}(k, seed); }
+};
+
+// the elements are sorted in place, the duplicate keys are rejected.
+template<typename T, typename CmpLess = less_key<T>>
+struct frozen_vector {
+private:
+    std::vector<T> m_data;
+
+public:
+    using key_compare = key_compare_t<CmpLess, T>;
+
+    explicit frozen_vector(std::vector<T> data)
+        :m_data{std::move(data)}
+    {
+        details::sort(m_data.begin(), m_data.end(), CmpLess{});
+        if ( find_duplicate(m_data.begin(), m_data.size(), CmpLess{}) != m_data.size() ) {
+            throw std::invalid_argument("ctmap::frozen_map: duplicate keys");
+        }
+    }
+    template<typename InputIt>
+    frozen_vector(InputIt first, InputIt last)
+        :frozen_vector{std::vector<T>(first, last)}
+    {}
+    frozen_vector(std::initializer_list<T> list)
+        :frozen_vector{std::vector<T>(list)}
+    {}
+
+    std::size_t size() const noexcept { return m_data.size(); }
+    const T*    begin() const noexcept { return m_data.data(); }
+    const T*    end  () const noexcept { return m_data.data() + m_data.size(); }
+
+    const T& operator[](std::size_t i) const noexcept { return m_data[i]; }
+
+    template<typename Key>
+    std::size_t find_index(const Key &k) const noexcept
+    { return details::find_index(begin(), size(), k, key_compare{}); }
+
+    template<typename Key>
+    std::size_t find_index_probes(const Key &k, std::size_t &probes) const noexcept
+    { return details::find_index(begin(), size(), k, counting_compare<key_compare>{&probes}); }
+
+    template<typename Key>
+    void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept
+    { details::find_index_batch(begin(), size(), keys, count, out, key_compare{}); }
+
+    template<typename RStorage, typename CmpEqual>
+    bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept {
+        if ( r.size() != size() ) {
+            return false;
+        }
+        for ( std::size_t i = 0; i < size(); ++i ) {
+            if ( !cmp(m_data[i], r[i]) ) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+/*************************************************************************************************/
+
+// the indices are 32-bit, so the size is limited to 4G - 1 elements.
+template<typename T, typename CmpLess = less_key<T>, typename Hash = hash<key_type_t<T>>>
+struct frozen_pmh_storage {
+public:
+    using key_compare = key_compare_t<CmpLess, T>;
+
+private:
+    static_assert(is_equality_order_v<CmpLess, T>
+        ,"frozen_pmh_storage requires the natural order of the keys or its reverse, the hits are tested with `==`");
+
+    frozen_vector<T, CmpLess> m_vec;
+    std::size_t m_m;
+    std::uint64_t m_seed;
+    std::vector<std::uint64_t> m_g;
+    std::vector<std::uint32_t> m_h;
+
+public:
+    template<typename ...U>
+    frozen_pmh_storage(U && ...args)
+        :m_vec{std::forward<U>(args)...}
+        ,m_m{next_pow2(m_vec.size())}
+        ,m_seed{}
+        ,m_g(m_m)
+        ,m_h(m_m)
+    {
+        if ( m_vec.size() >= std::numeric_limits<std::uint32_t>::max() ) {
+            throw std::length_error("ctmap::frozen_map: too many elements");
+        }
+        std::vector<std::size_t> scratch(m_vec.size() + 2*m_m + 1);
+        m_seed = pmh_build(m_vec.begin(), m_vec.size(), m_m, Hash{}, m_g.data(), m_h.data(), scratch.data());
+    }
+    frozen_pmh_storage(std::initializer_list<T> list)
+        :frozen_pmh_storage{std::vector<T>(list)}
+    {}
+
+    std::size_t size() const noexcept { return m_vec.size(); }
+    const T*    begin() const noexcept { return m_vec.begin(); }
+    const T*    end  () const noexcept { return m_vec.end(); }
+
+    const T& operator[](std::size_t i) const noexcept { return m_vec[i]; }
+
+    template<typename Key>
+    std::size_t find_index(const Key &k) const noexcept
+    { return pmh_find_index(begin(), size(), m_seed, m_g.data(), m_h.data(), m_m, Hash{}, k); }
+
+    // one key compare, unless the slot is empty
+    template<typename Key>
+    std::size_t find_index_probes(const Key &k, std::size_t &probes) const noexcept {
+        const std::size_t idx = m_h[pmh_slot(k, m_seed, m_g.data(), m_m, Hash{})];
+        if ( idx == size() ) {
+            return idx;
+        }
+        ++probes;
+        return (key_of(m_vec[idx]) == k) ? idx : size();
+    }
+
+    template<typename Key>
+    void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept
+    { pmh_find_index_batch(begin(), size(), m_seed, m_g.data(), m_h.data(), m_m, Hash{}, keys, count, out); }
+
+    template<typename RStorage, typename CmpEqual>
+    bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept
+    { return m_vec.equal(r, cmp); }
+};
+
+/*************************************************************************************************/
+
+template<typename T, typename CmpLess = less_key<T>>
+struct frozen_eytzinger_storage {
+public:
+    using key_compare = key_compare_t<CmpLess, T>;
+
+private:
+    using key_type = key_type_t<T>;
+
+    frozen_vector<T, CmpLess> m_vec;
+    // the both are 1-based, the zero element of `m_ranks` is the "not found" marker
+    std::vector<key_type> m_keys;
+    std::vector<std::uint32_t> m_ranks;
+
+public:
+    template<typename ...U>
+    frozen_eytzinger_storage(U && ...args)
+        :m_vec{std::forward<U>(args)...}
+        ,m_keys(m_vec.size() + 1)
+        ,m_ranks(m_vec.size() + 1)
+    {
+        if ( m_vec.size() >= std::numeric_limits<std::uint32_t>::max() ) {
+            throw std::length_error("ctmap::frozen_map: too many elements");
+        }
+        eytzinger_build(m_vec.begin(), m_vec.size(), 0, 1, m_keys.data(), m_ranks.data());
+        m_ranks[0] = static_cast<std::uint32_t>(m_vec.size());
+    }
+    frozen_eytzinger_storage(std::initializer_list<T> list)
+        :frozen_eytzinger_storage{std::vector<T>(list)}
+    {}
+
+    std::size_t size() const noexcept { return m_vec.size(); }
+    const T*    begin() const noexcept { return m_vec.begin(); }
+    const T*    end  () const noexcept { return m_vec.end(); }
+
+    const T& operator[](std::size_t i) const noexcept { return m_vec[i]; }
+
+    template<typename Key>
+    std::size_t find_index(const Key &k) const noexcept
+    { return eytzinger_find_index(begin(), size(), m_keys.data(), m_ranks.data(), k, key_compare{}); }
+
+    template<typename Key>
+    std::size_t find_index_probes(const Key &k, std::size_t &probes) const noexcept {
+        return eytzinger_find_index(begin(), size(), m_keys.data(), m_ranks.data(), k
+            ,counting_compare<key_compare>{&probes});
+    }
+
+    template<typename Key>
+    void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept
+    { eytzinger_find_index_batch(begin(), size(), m_keys.data(), m_ranks.data(), keys, count, out, key_compare{}); }
+
+    template<typename RStorage, typename CmpEqual>
+    bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept
+    { return m_vec.equal(r, cmp); }
+};
+
+} // ns details
+
+/*************************************************************************************************/
+
+// the map is built once at runtime, from a range, an initializer list or a vector which
+// is sorted in place; after that it provides the same read-only interface as `ctmap::map`.
+template<
+     typename K
+    ,typename V
+    ,typename CmpLess = details::less_key<std::pair<K, V>>
+    ,typename Storage = details::frozen_vector<std::pair<K, V>, CmpLess>
+>
+struct frozen_map: basic_map<K, V, Storage> {
+    using basic_map<K, V, Storage>::basic_map;
+
+    frozen_map(std::initializer_list<std::pair<K, V>> list)
+        :basic_map<K, V, Storage>{std::vector<std::pair<K, V>>(list)}
+    {}
+
+    template<typename RCmpLess, typename RStorage, typename CmpEqual>
+    bool equal(const frozen_map<K, V, RCmpLess, RStorage> &r, const CmpEqual &cmp) const noexcept
+    { return this->vec.equal(r.storage(), cmp); }
+};
+
+template<
+     typename K
+    ,typename V
+    ,typename Hash = details::hash<K>
+    ,typename CmpLess = details::less_key<std::pair<K, V>>
+>
+using frozen_unordered_map = frozen_map<K, V, CmpLess, details::frozen_pmh_storage<std::pair<K, V>, CmpLess, Hash>>;
+
+template<
+     typename K
+    ,typename V
+    ,typename CmpLess = details::less_key<std::pair<K, V>>
+>
+using frozen_eytzinger_map = frozen_map<K, V, CmpLess, details::frozen_eytzinger_storage<std::pair<K, V>, CmpLess>>;
+
+// the key and value types are deduced from the range, so a `std::map` or a `std::unordered_map` can be frozen.
+template<typename InputIt>
+auto make_frozen_map(InputIt first, InputIt last) {
+    using value_type = typename std::iterator_traits<InputIt>::value_type;
+    using K = std::remove_const_t<typename value_type::first_type>;
+    using V = typename value_type::second_type;
+    return frozen_map<K, V>{first, last};
+}
+
+} // ns ctmap
+
+/*************************************************************************************************/
+
+#endif // __CTMAP__FROZEN_MAP_HPP
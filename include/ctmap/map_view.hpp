@@ -0,0 +1,455 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------
+
+#ifndef __CTMAP__MAP_VIEW_HPP
+#define __CTMAP__MAP_VIEW_HPP
+
+#include <ctmap/ctmap.hpp>
+
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#   define CTMAP_HAS_MMAP 1
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+// the flat image of a map: a header followed by the 64-bytes aligned sections,
+// all of them are in the host byte order.
+//   keys    K[count]      - in the sorted order
+//   values  V[count]      - in the order of the keys
+//   layout == pmh:
+//     aux0  u64[table]    - the CHD `g` table
+//     aux1  u32[table]    - the CHD `h` table
+//   layout == eytzinger:
+//     aux0  K[count + 1]  - the keys in the Eytzinger order, 1-based
+//     aux1  u32[count + 1]- the ranks of the Eytzinger keys, `aux1[0] == count`
+
+namespace ctmap {
+
+enum class image_layout: std::uint32_t { sorted, pmh, eytzinger };
+
+namespace details {
+
+struct image_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t layout;
+    std::uint32_t key_size;
+    std::uint32_t value_size;
+    std::uint32_t reserved;
+    std::uint64_t count;
+    std::uint64_t table_size;
+    std::uint64_t seed;
+    std::uint64_t keys;
+    std::uint64_t values;
+    std::uint64_t aux0;
+    std::uint64_t aux1;
+    std::uint64_t file_size;
+};
+
+constexpr char image_magic[8] = {'c', 't', 'm', 'a', 'p', 'i', 'm', 'g'};
+constexpr std::uint32_t image_version = 1;
+constexpr std::uint32_t image_byte_order = 0x01020304u;
+constexpr std::uint64_t image_align = 64;
+
+constexpr std::uint64_t image_aligned(std::uint64_t off) noexcept
+{ return (off + image_align - 1) & ~(image_align - 1); }
+
+template<typename T>
+struct is_string_view: std::false_type {};
+
+template<typename C, typename Traits>
+struct is_string_view<std::basic_string_view<C, Traits>>: std::true_type {};
+
+// the bytes of the type have to mean the same in any process mapping the image: the pointers
+// and the views are only valid in the process that wrote them. (a pointer inside of a struct
+// can't be detected)
+template<typename T>
+constexpr bool is_image_type_v =
+    std::is_trivially_copyable<T>::value
+    && !std::is_pointer<T>::value
+    && !std::is_member_pointer<T>::value
+    && !is_string_view<T>::value
+;
+
+// only the pmh layout is hashing the keys, the other ones are taking any ordered key.
+// the hash is defined when it's a complete type.
+template<typename Hash, typename = void>
+struct has_hash: std::false_type {};
+
+template<typename Hash>
+struct has_hash<Hash, std::void_t<decltype(sizeof(Hash))>>: std::true_type {};
+
+/*************************************************************************************************/
+
+// owns a read-only file mapping.
+struct mapped_file {
+    const void *addr = nullptr;
+    std::size_t size = 0;
+
+    mapped_file() noexcept = default;
+    mapped_file(const mapped_file &) = delete;
+    mapped_file& operator=(const mapped_file &) = delete;
+    mapped_file(mapped_file &&r) noexcept
+        :addr{r.addr}
+        ,size{r.size}
+    { r.addr = nullptr; r.size = 0; }
+    mapped_file& operator=(mapped_file &&r) noexcept {
+        std::swap(addr, r.addr);
+        std::swap(size, r.size);
+        return *this;
+    }
+    ~mapped_file() {
+#if defined(CTMAP_HAS_MMAP)
+        if ( addr ) {
+            ::munmap(const_cast<void *>(addr), size);
+        }
+#endif
+    }
+
+#if defined(CTMAP_HAS_MMAP)
+    explicit mapped_file(const char *path) {
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if ( fd < 0 ) {
+            throw std::runtime_error("ctmap::map_view: can't open the image");
+        }
+        struct stat st{};
+        if ( ::fstat(fd, &st) != 0 || st.st_size <= 0 ) {
+            ::close(fd);
+            throw std::runtime_error("ctmap::map_view: can't stat the image");
+        }
+        void *p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if ( p == MAP_FAILED ) {
+            throw std::runtime_error("ctmap::map_view: can't map the image");
+        }
+        addr = p;
+        size = static_cast<std::size_t>(st.st_size);
+    }
+#endif
+};
+
+/*************************************************************************************************/
+
+// answers the lookups directly from the image, nothing is copied.
+template<typename K, typename V, typename Hash = hash<K>>
+struct image_storage {
+private:
+    mapped_file m_file;
+    image_layout m_layout;
+    std::size_t m_size;
+    std::size_t m_table;
+    std::uint64_t m_seed;
+    const K *m_keys;
+    const V *m_values;
+    const void *m_aux0;
+    const std::uint32_t *m_aux1;
+
+    template<typename T>
+    static const T* section(const unsigned char *base, std::size_t size, std::uint64_t off, std::uint64_t count) {
+        if ( off % image_align != 0 || off > size || count > (size - off) / sizeof(T) ) {
+            throw std::runtime_error("ctmap::map_view: the section is out of the image");
+        }
+        return reinterpret_cast<const T *>(base + off);
+    }
+
+    // the lookups are using the stored slots and ranks as the indices without the bounds
+    // checks, so every one of them is checked once here
+    void check_tables() const {
+        if ( m_layout == image_layout::pmh ) {
+            const auto *g = static_cast<const std::uint64_t *>(m_aux0);
+            for ( std::size_t i = 0; i < m_table; ++i ) {
+                if ( ((g[i] & pmh_direct) && (g[i] & ~pmh_direct) >= m_table) || m_aux1[i] > m_size ) {
+                    throw std::runtime_error("ctmap::map_view: the hash table is corrupted");
+                }
+            }
+        } else if ( m_layout == image_layout::eytzinger ) {
+            if ( m_aux1[0] != m_size ) {
+                throw std::runtime_error("ctmap::map_view: the ranks table is corrupted");
+            }
+            for ( std::size_t i = 1; i <= m_size; ++i ) {
+                if ( m_aux1[i] >= m_size ) {
+                    throw std::runtime_error("ctmap::map_view: the ranks table is corrupted");
+                }
+            }
+        }
+    }
+
+public:
+    // `data` must be aligned to 64 bytes, and has to outlive the storage.
+    image_storage(const void *data, std::size_t size, mapped_file file = mapped_file{})
+        :m_file{std::move(file)}
+    {
+        static_assert(is_image_type_v<K> && is_image_type_v<V>
+            ,"the image can only keep the trivially copyable keys and values, without the pointers and views");
+
+        const auto *base = static_cast<const unsigned char *>(data);
+        if ( reinterpret_cast<std::uintptr_t>(base) % image_align != 0 ) {
+            throw std::invalid_argument("ctmap::map_view: the image must be aligned to 64 bytes");
+        }
+        if ( size < sizeof(image_header) ) {
+            throw std::runtime_error("ctmap::map_view: the image is truncated");
+        }
+        image_header h;
+        std::memcpy(&h, base, sizeof(h));
+        if ( std::memcmp(h.magic, image_magic, sizeof(image_magic)) != 0 ) {
+            throw std::runtime_error("ctmap::map_view: not an image");
+        }
+        if ( h.version != image_version || h.byte_order != image_byte_order ) {
+            throw std::runtime_error("ctmap::map_view: unsupported image version or byte order");
+        }
+        if ( h.key_size != sizeof(K) || h.value_size != sizeof(V) ) {
+            throw std::runtime_error("ctmap::map_view: the key or value type does not match the image");
+        }
+        if ( h.file_size > size || h.count >= std::numeric_limits<std::uint32_t>::max() ) {
+            throw std::runtime_error("ctmap::map_view: the image is truncated");
+        }
+
+        m_layout = static_cast<image_layout>(h.layout);
+        m_size = static_cast<std::size_t>(h.count);
+        m_table = static_cast<std::size_t>(h.table_size);
+        m_seed = h.seed;
+        m_keys = section<K>(base, size, h.keys, h.count);
+        m_values = section<V>(base, size, h.values, h.count);
+        switch ( m_layout ) {
+            case image_layout::sorted:
+                m_aux0 = nullptr;
+                m_aux1 = nullptr;
+                break;
+            case image_layout::pmh:
+                if constexpr ( !has_hash<Hash>::value ) {
+                    throw std::runtime_error("ctmap::map_view: the pmh layout needs a hashable key type");
+                }
+                if ( m_table == 0 || (m_table & (m_table - 1)) != 0 ) {
+                    throw std::runtime_error("ctmap::map_view: bad hash table size");
+                }
+                m_aux0 = section<std::uint64_t>(base, size, h.aux0, h.table_size);
+                m_aux1 = section<std::uint32_t>(base, size, h.aux1, h.table_size);
+                break;
+            case image_layout::eytzinger:
+                m_aux0 = section<K>(base, size, h.aux0, h.count + 1);
+                m_aux1 = section<std::uint32_t>(base, size, h.aux1, h.count + 1);
+                break;
+            default:
+                throw std::runtime_error("ctmap::map_view: unknown image layout");
+        }
+        check_tables();
+    }
+    explicit image_storage(mapped_file file)
+        :image_storage{file.addr, file.size, std::move(file)}
+    {}
+
+    image_layout layout() const noexcept { return m_layout; }
+
+    std::size_t size () const noexcept { return m_size; }
+    auto        begin() const noexcept { return index_iterator<image_storage>{this, 0}; }
+    auto        end  () const noexcept { return index_iterator<image_storage>{this, m_size}; }
+
+    std::pair<const K &, const V &> operator[](std::size_t i) const noexcept
+    { return {m_keys[i], m_values[i]}; }
+
+    template<typename Key>
+    std::size_t find_index(const Key &k) const noexcept {
+        switch ( m_layout ) {
+            case image_layout::pmh:
+                if constexpr ( has_hash<Hash>::value ) {
+                    return pmh_find_index(m_keys, m_size, m_seed
+                        ,static_cast<const std::uint64_t *>(m_aux0), m_aux1, m_table, Hash{}, k);
+                }
+                return m_size;
+            case image_layout::eytzinger:
+                return eytzinger_find_index(m_keys, m_size, static_cast<const K *>(m_aux0), m_aux1, k);
+            default:
+                return details::find_index(m_keys, m_size, k);
+        }
+    }
+
+    template<typename Key>
+    void find_index_batch(const Key *keys, std::size_t count, std::size_t *out) const noexcept {
+        switch ( m_layout ) {
+            case image_layout::pmh:
+                if constexpr ( has_hash<Hash>::value ) {
+                    pmh_find_index_batch(m_keys, m_size, m_seed
+                        ,static_cast<const std::uint64_t *>(m_aux0), m_aux1, m_table, Hash{}, keys, count, out);
+                }
+                break;
+            case image_layout::eytzinger:
+                eytzinger_find_index_batch(m_keys, m_size, static_cast<const K *>(m_aux0), m_aux1, keys, count, out);
+                break;
+            default:
+                details::find_index_batch(m_keys, m_size, keys, count, out);
+        }
+    }
+
+    template<typename RStorage, typename CmpEqual>
+    bool equal(const RStorage &r, const CmpEqual &cmp) const noexcept {
+        if ( r.size() != m_size ) {
+            return false;
+        }
+        for ( std::size_t i = 0; i < m_size; ++i ) {
+            if ( !cmp((*this)[i], r[i]) ) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+inline void image_write(std::ostream &os, const void *data, std::size_t size, std::uint64_t &pos) {
+    static const char zeros[image_align] = {};
+    if ( data ) {
+        os.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    } else {
+        os.write(zeros, static_cast<std::streamsize>(size));
+    }
+    pos += size;
+}
+
+} // ns details
+
+/*************************************************************************************************/
+
+// writes the image of any map (`ctmap::map`, `ctmap::frozen_map` or `ctmap::map_view`) with
+// the trivially copyable keys and values, which are not pointers or views (`std::string_view`).
+// the search tables are rebuilt for the `layout`, only the pmh one needs the keys to be hashable.
+template<typename Map, typename Hash = details::hash<std::decay_t<decltype(std::declval<const Map &>()[0].first)>>>
+void write_image(std::ostream &os, const Map &m, image_layout layout = image_layout::pmh) {
+    using K = std::decay_t<decltype(m[0].first)>;
+    using V = std::decay_t<decltype(m[0].second)>;
+    static_assert(details::is_image_type_v<K> && details::is_image_type_v<V>
+        ,"the image can only keep the trivially copyable keys and values, without the pointers and views");
+    static_assert(std::is_same<typename Map::key_compare, std::less<>>::value
+        ,"the image is searched in the natural order of the keys");
+
+    const std::size_t n = m.size();
+    if ( n >= std::numeric_limits<std::uint32_t>::max() ) {
+        throw std::length_error("ctmap::write_image: too many elements");
+    }
+    std::vector<K> keys(n);
+    std::vector<V> values(n);
+    for ( std::size_t i = 0; i < n; ++i ) {
+        keys[i] = m[i].first;
+        values[i] = m[i].second;
+    }
+
+    details::image_header h{};
+    std::memcpy(h.magic, details::image_magic, sizeof(h.magic));
+    h.version = details::image_version;
+    h.byte_order = details::image_byte_order;
+    h.layout = static_cast<std::uint32_t>(layout);
+    h.key_size = sizeof(K);
+    h.value_size = sizeof(V);
+    h.count = n;
+
+    std::vector<std::uint64_t> g;
+    std::vector<K> ekeys;
+    std::vector<std::uint32_t> aux1;
+    std::size_t aux0_size = 0;
+    switch ( layout ) {
+        case image_layout::sorted:
+            break;
+        case image_layout::pmh: {
+            if constexpr ( !details::has_hash<Hash>::value ) {
+                throw std::invalid_argument("ctmap::write_image: the pmh layout needs a hashable key type");
+            }
+            h.table_size = details::next_pow2(n);
+            g.resize(h.table_size);
+            aux1.resize(h.table_size);
+            std::vector<std::size_t> scratch(n + 2*h.table_size + 1);
+            if constexpr ( details::has_hash<Hash>::value ) {
+                h.seed = details::pmh_build(keys.data(), n, h.table_size, Hash{}, g.data(), aux1.data(), scratch.data());
+            }
+            aux0_size = g.size() * sizeof(std::uint64_t);
+            break;
+        }
+        case image_layout::eytzinger: {
+            ekeys.resize(n + 1);
+            aux1.resize(n + 1);
+            details::eytzinger_build(keys.data(), n, 0, 1, ekeys.data(), aux1.data());
+            aux1[0] = static_cast<std::uint32_t>(n);
+            aux0_size = ekeys.size() * sizeof(K);
+            break;
+        }
+        default:
+            throw std::invalid_argument("ctmap::write_image: unknown layout");
+    }
+
+    h.keys = details::image_aligned(sizeof(h));
+    h.values = details::image_aligned(h.keys + n * sizeof(K));
+    h.aux0 = details::image_aligned(h.values + n * sizeof(V));
+    h.aux1 = details::image_aligned(h.aux0 + aux0_size);
+    h.file_size = h.aux1 + aux1.size() * sizeof(std::uint32_t);
+
+    const void *aux0 = g.empty() ? static_cast<const void *>(ekeys.data()) : g.data();
+    const struct { const void *data; std::size_t size; std::uint64_t off; } sections[] = {
+         {keys.data(), n * sizeof(K), h.keys}
+        ,{values.data(), n * sizeof(V), h.values}
+        ,{aux0, aux0_size, h.aux0}
+        ,{aux1.data(), aux1.size() * sizeof(std::uint32_t), h.aux1}
+    };
+    std::uint64_t pos = 0;
+    details::image_write(os, &h, sizeof(h), pos);
+    for ( const auto &s: sections ) {
+        details::image_write(os, nullptr, s.off - pos, pos);
+        details::image_write(os, s.data, s.size, pos);
+    }
+    if ( !os ) {
+        throw std::runtime_error("ctmap::write_image: write error");
+    }
+}
+
+// a read-only map over an image written by `write_image()`. the lookups are using the
+// image memory directly, so nothing is copied and the mapped pages are shared between processes.
+// opening reads the search tables once to reject a truncated or corrupted image.
+template<typename K, typename V, typename Hash = details::hash<K>>
+struct map_view: basic_map<K, V, details::image_storage<K, V, Hash>> {
+    using basic_map<K, V, details::image_storage<K, V, Hash>>::basic_map;
+
+    image_layout layout() const noexcept { return this->vec.layout(); }
+
+    // compares with any map, e.g. the one the image was written from
+    template<typename RMap, typename CmpEqual>
+    bool equal(const RMap &r, const CmpEqual &cmp) const noexcept
+    { return this->vec.equal(r.storage(), cmp); }
+
+#if defined(CTMAP_HAS_MMAP)
+    static map_view open(const char *path)
+    { return map_view{details::mapped_file{path}}; }
+#endif
+};
+
+} // ns ctmap
+
+/*************************************************************************************************/
+
+#endif // __CTMAP__MAP_VIEW_HPP
@@ -0,0 +1,178 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------
+
+#ifndef __CTMAP__STATS_HPP
+#define __CTMAP__STATS_HPP
+
+#include <ctmap/ctmap.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <vector>
+
+/*************************************************************************************************/
+
+namespace ctmap {
+
+// counts the hits and the probes per key, and the misses of the lookups of a map, using the relaxed
+// atomics. the maps are `constexpr` objects so the counters are kept aside, one set per map type:
+// the maps which should be counted separately are using different `Tag`s. the lookups of the
+// counted maps are counting their probes, and the batch lookups are not interleaving the searches.
+// the counters are allocated on the first lookup, without them nothing is counted.
+//   struct commands_tag;
+//   static constexpr auto m = ctmap::with_stats<ctmap::counting_stats<commands_tag>>(ctmap::make_map(...));
+//   ...
+//   ctmap::dump_stats(m, std::cerr);
+template<typename Tag = void>
+struct counting_stats {
+    struct counters {
+        explicit counters(std::size_t n) noexcept
+            :size{n}
+            ,hits{new (std::nothrow) std::atomic<std::uint64_t>[n + 1]{}}
+            ,probes{new (std::nothrow) std::atomic<std::uint64_t>[n + 1]{}}
+        {
+            if ( !hits || !probes ) {
+                hits.reset();
+                probes.reset();
+            }
+        }
+
+        std::size_t size;
+        // the last ones are counting the misses
+        std::unique_ptr<std::atomic<std::uint64_t>[]> hits;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> probes;
+    };
+
+    template<typename Map>
+    static counters& counters_of(std::size_t size) noexcept {
+        static counters c{size};
+        return c;
+    }
+
+    template<typename Map>
+    static void record(std::size_t idx, std::size_t size, std::size_t probes) noexcept {
+        counters &c = counters_of<Map>(size);
+        if ( !c.hits ) {
+            return;
+        }
+        c.hits[idx].fetch_add(1, std::memory_order_relaxed);
+        c.probes[idx].fetch_add(probes, std::memory_order_relaxed);
+    }
+};
+
+template<typename K>
+struct key_stats {
+    K key;
+    std::uint64_t hits;
+    // the sum over the hits
+    std::uint64_t probes;
+};
+
+template<typename K>
+struct lookup_stats {
+    // the keys which were found at least once, the most frequent first
+    std::vector<key_stats<K>> hits;
+    std::uint64_t misses;
+    std::uint64_t miss_probes;
+    std::uint64_t lookups;
+    // the sum over the hits and the misses
+    std::uint64_t probes;
+};
+
+// a snapshot of the counters, the counting is going on
+template<typename K, typename V, typename Storage, typename Tag>
+lookup_stats<K> get_stats(const basic_map<K, V, Storage, counting_stats<Tag>> &m) {
+    using stats_type = counting_stats<Tag>;
+    const auto &c = stats_type::template counters_of<basic_map<K, V, Storage, stats_type>>(m.size());
+
+    lookup_stats<K> res{};
+    if ( !c.hits ) {
+        return res;
+    }
+    res.misses = c.hits[m.size()].load(std::memory_order_relaxed);
+    res.miss_probes = c.probes[m.size()].load(std::memory_order_relaxed);
+    res.lookups = res.misses;
+    res.probes = res.miss_probes;
+    for ( std::size_t i = 0; i < m.size(); ++i ) {
+        const std::uint64_t n = c.hits[i].load(std::memory_order_relaxed);
+        if ( n ) {
+            const std::uint64_t probes = c.probes[i].load(std::memory_order_relaxed);
+            res.hits.push_back(key_stats<K>{m[i].first, n, probes});
+            res.lookups += n;
+            res.probes += probes;
+        }
+    }
+    std::stable_sort(res.hits.begin(), res.hits.end()
+        ,[](const auto &l, const auto &r) { return l.hits > r.hits; }
+    );
+
+    return res;
+}
+
+template<typename K, typename V, typename Storage, typename Tag>
+void reset_stats(const basic_map<K, V, Storage, counting_stats<Tag>> &m) noexcept {
+    using stats_type = counting_stats<Tag>;
+    auto &c = stats_type::template counters_of<basic_map<K, V, Storage, stats_type>>(m.size());
+    for ( std::size_t i = 0; c.hits && i <= m.size(); ++i ) {
+        c.hits[i].store(0, std::memory_order_relaxed);
+        c.probes[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// the summary line followed by the `<key> <hits> <share> <probes/hit>` lines, the most frequent keys first.
+// the enum keys are printed as their underlying values.
+template<typename K, typename V, typename Storage, typename Tag>
+void dump_stats(const basic_map<K, V, Storage, counting_stats<Tag>> &m, std::ostream &os) {
+    const auto stats = get_stats(m);
+    const double lookups = stats.lookups ? static_cast<double>(stats.lookups) : 1.0;
+    os << "lookups=" << stats.lookups
+       << " hits=" << (stats.lookups - stats.misses)
+       << " misses=" << stats.misses
+       << " probes/lookup=" << static_cast<double>(stats.probes) / lookups
+       << " probes/miss=" << (stats.misses ? static_cast<double>(stats.miss_probes) / stats.misses : 0.0)
+       << '\n';
+    for ( const auto &it: stats.hits ) {
+        if constexpr ( std::is_enum<K>::value ) {
+            os << +static_cast<std::underlying_type_t<K>>(it.key);
+        } else {
+            os << it.key;
+        }
+        os << ' ' << it.hits
+           << ' ' << static_cast<double>(it.hits) / lookups
+           << ' ' << static_cast<double>(it.probes) / it.hits
+           << '\n';
+    }
+}
+
+} // ns ctmap
+
+/*************************************************************************************************/
+
+#endif // __CTMAP__STATS_HPP
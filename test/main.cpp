@@ -25,9 +25,21 @@
 // ----------------------------------------------------------------------------
 
 #include <ctmap/ctmap.hpp>
+#include <ctmap/frozen_map.hpp>
+#include <ctmap/map_view.hpp>
+#include <ctmap/stats.hpp>
 
 #include <iostream>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #ifdef NDEBUG
 #   error "This file MUST be compiled with NDEBUG undefined!"
@@ -42,6 +54,29 @@ struct pair_cmp_less {
 
 int func(int v) { return v; }
 
+// case insensitive, and transparent: it accepts anything convertible to `std::string_view`
+struct ci_less {
+    using is_transparent = void;
+
+    static constexpr char lower(char c) noexcept { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+
+    constexpr bool operator() (std::string_view l, std::string_view r) const noexcept {
+        for ( std::size_t i = 0; i < l.size() && i < r.size(); ++i ) {
+            if ( lower(l[i]) != lower(r[i]) ) {
+                return lower(l[i]) < lower(r[i]);
+            }
+        }
+        return l.size() < r.size();
+    }
+};
+
+enum class color: std::uint8_t { red, green, blue, black = 0xff };
+
+template<typename K, K Mul, K Add, std::size_t ...Is>
+constexpr auto make_soa_seq(std::index_sequence<Is...>) {
+    return ctmap::make_soa_map(std::make_pair(static_cast<K>(Is * Mul + Add), Is)...);
+}
+
 /***********************************************************************************/
 
 int main(int argc, char **) {
@@ -189,6 +224,1017 @@ int main(int argc, char **) {
         }
     }
 
+    {
+        constexpr auto m = ctmap::make_unordered_map(
+             std::make_pair(10, 0)
+            ,std::make_pair(40, 1)
+            ,std::make_pair(20, 2)
+            ,std::make_pair(50, 3)
+            ,std::make_pair(30, 4)
+        );
+        static_assert(m.size() == 5, "");
+
+        static_assert(m[0].first == 10 && m[0].second == 0, "");
+        static_assert(m[4].first == 50 && m[4].second == 3, "");
+
+        static_assert(m.find(10).first == true && m.find(10).second == 0, "");
+        static_assert(m.find(40).first == true && m.find(40).second == 1, "");
+        static_assert(m.find(20).first == true && m.find(20).second == 2, "");
+        static_assert(m.find(50).first == true && m.find(50).second == 3, "");
+        static_assert(m.find(30).first == true && m.find(30).second == 4, "");
+        static_assert(m.find(35).first == false, "");
+        static_assert(!m.contains(0), "");
+
+        constexpr auto m1 = ctmap::make_map(
+             std::make_pair(10, 0)
+            ,std::make_pair(40, 1)
+            ,std::make_pair(20, 2)
+            ,std::make_pair(50, 3)
+            ,std::make_pair(30, 4)
+        );
+        static_assert(m.equal(m1, [](const auto &l, const auto &r){ return l == r; }));
+
+        for ( int i = 0; i < 64; ++i ) {
+            assert(m.contains(i) == m1.contains(i));
+        }
+    }
+    {
+        using namespace std::literals;
+        static constexpr auto m = ctmap::make_unordered_map(
+             std::make_pair("get"sv, 0)
+            ,std::make_pair("set"sv, 1)
+            ,std::make_pair("del"sv, 2)
+            ,std::make_pair("incr"sv, 3)
+        );
+
+        static_assert(m.find("get"sv).second == 0, "");
+        static_assert(m.find("set"sv).second == 1, "");
+        static_assert(m.find("del"sv).second == 2, "");
+        static_assert(m.find("incr"sv).second == 3, "");
+        static_assert(!m.contains("decr"sv), "");
+
+        assert(m.find(std::string_view{"incr"}).second == 3);
+        assert(!m.contains(std::string_view{"inc"}));
+    }
+
+    {
+        constexpr auto m = ctmap::make_eytzinger_map(
+             std::make_pair(10, 0)
+            ,std::make_pair(40, 1)
+            ,std::make_pair(20, 2)
+            ,std::make_pair(50, 3)
+            ,std::make_pair(30, 4)
+            ,std::make_pair(60, 5)
+        );
+        static_assert(m.size() == 6, "");
+
+        static_assert(m[0].first == 10 && m[0].second == 0, "");
+        static_assert(m[5].first == 60 && m[5].second == 5, "");
+
+        static_assert(m.find(10).first == true && m.find(10).second == 0, "");
+        static_assert(m.find(40).first == true && m.find(40).second == 1, "");
+        static_assert(m.find(20).first == true && m.find(20).second == 2, "");
+        static_assert(m.find(50).first == true && m.find(50).second == 3, "");
+        static_assert(m.find(30).first == true && m.find(30).second == 4, "");
+        static_assert(m.find(60).first == true && m.find(60).second == 5, "");
+        static_assert(!m.contains(5) && !m.contains(35) && !m.contains(65), "");
+
+        int prev = 0;
+        for ( const auto &it: m ) {
+            assert(prev < it.first);
+            prev = it.first;
+        }
+        for ( int i = 0; i < 70; ++i ) {
+            assert(m.contains(i) == (i % 10 == 0 && i >= 10 && i <= 60));
+        }
+    }
+
+    {
+        constexpr auto m = ctmap::make_soa_map(
+             std::make_pair(3, func)
+            ,std::make_pair(1, func)
+            ,std::make_pair(2, func)
+            ,std::make_pair(5, func)
+        );
+        static_assert(m.size() == 4, "");
+        static_assert(m[0].first == 1 && m[3].first == 5, "");
+        static_assert(m.storage().keys()[1] == 2, "");
+        static_assert(m.find(5).first && m.find(5).second == func, "");
+        static_assert(!m.contains(4), "");
+        static_assert(m.end() - m.begin() == 4, "");
+        static_assert(m.begin()->first == 1, "");
+
+        int prev = 0;
+        for ( const auto &it: m ) {
+            assert(prev < it.first);
+            assert(it.second(it.first) == it.first);
+            prev = it.first;
+        }
+    }
+
+    {
+        // the SIMD linear search
+        constexpr auto m0 = make_soa_seq<std::int32_t, 7, -100>(std::make_index_sequence<40>{});
+        // the S-tree search
+        constexpr auto m1 = make_soa_seq<std::int32_t, 7, -1000>(std::make_index_sequence<300>{});
+        constexpr auto m2 = make_soa_seq<std::uint32_t, 1000003u, 0xf0000000u>(std::make_index_sequence<300>{});
+        constexpr auto m3 = make_soa_seq<std::uint64_t, 0x100000001ull, 5>(std::make_index_sequence<100>{});
+        constexpr auto m4 = make_soa_seq<std::int16_t, 3, -60>(std::make_index_sequence<100>{});
+        static_assert(m0.find(-100).second == 0 && m1.find(-993).second == 1, "");
+
+        for ( std::int32_t k = -1100; k < 1200; ++k ) {
+            const bool hit0 = k >= -100 && k < -100 + 7*40 && (k + 100) % 7 == 0;
+            assert(m0.contains(k) == hit0);
+            assert(!hit0 || m0.find(k).second == static_cast<std::size_t>((k + 100) / 7));
+
+            const bool hit1 = k >= -1000 && k < -1000 + 7*300 && (k + 1000) % 7 == 0;
+            assert(m1.contains(k) == hit1);
+            assert(!hit1 || m1.find(k).second == static_cast<std::size_t>((k + 1000) / 7));
+
+            const bool hit4 = k >= -60 && k < -60 + 3*100 && (k + 60) % 3 == 0;
+            assert(m4.contains(static_cast<std::int16_t>(k)) == hit4);
+        }
+        for ( std::size_t i = 0; i < 300; ++i ) {
+            const auto k = static_cast<std::uint32_t>(i * 1000003u + 0xf0000000u);
+            assert(m2.find(k).first && m2.find(k).second == i);
+            assert(!m2.contains(k + 1));
+        }
+        for ( std::size_t i = 0; i < 100; ++i ) {
+            const auto k = i * 0x100000001ull + 5;
+            assert(m3.find(k).first && m3.find(k).second == i);
+            assert(!m3.contains(k + 1) && !m3.contains(k + (1ull << 32)));
+        }
+
+        constexpr auto m5 = ctmap::make_soa_map(
+             std::make_pair(color::black, 3)
+            ,std::make_pair(color::green, 1)
+            ,std::make_pair(color::red, 0)
+        );
+        assert(m5.find(color::black).second == 3);
+        assert(m5.find(color::red).second == 0);
+        assert(!m5.contains(color::blue));
+    }
+
+    {
+        // no holes
+        constexpr auto m0 = ctmap::make_map(
+             std::make_pair(-1, 0)
+            ,std::make_pair(2, 3)
+            ,std::make_pair(0, 1)
+            ,std::make_pair(1, 2)
+        );
+        static_assert(m0.storage().is_dense(), "");
+        static_assert(m0.find(-1).second == 0 && m0.find(2).second == 3, "");
+        static_assert(!m0.contains(-2) && !m0.contains(3), "");
+
+        // with holes
+        constexpr auto m1 = ctmap::make_map(
+             std::make_pair(10u, 'a')
+            ,std::make_pair(12u, 'b')
+            ,std::make_pair(15u, 'c')
+            ,std::make_pair(16u, 'd')
+        );
+        static_assert(m1.storage().is_dense(), "");
+        static_assert(m1.find(10u).second == 'a' && m1.find(12u).second == 'b', "");
+        static_assert(m1.find(15u).second == 'c' && m1.find(16u).second == 'd', "");
+        static_assert(!m1.contains(11u) && !m1.contains(9u) && !m1.contains(17u), "");
+
+        // too sparse
+        constexpr auto m2 = ctmap::make_map(
+             std::make_pair(color::black, 3)
+            ,std::make_pair(color::red, 0)
+        );
+        static_assert(!m2.storage().is_dense(), "");
+        static_assert(m2.find(color::black).second == 3 && !m2.contains(color::green), "");
+
+        for ( int i = -5; i < 5; ++i ) {
+            assert(m0.contains(i) == (i >= -1 && i <= 2));
+            assert(!m0.contains(i) || m0.find(i).second == i + 1);
+        }
+        for ( unsigned i = 0; i < 20; ++i ) {
+            assert(m1.contains(i) == (i == 10 || i == 12 || i == 15 || i == 16));
+        }
+        assert(m2.contains(color::red) && !m2.contains(color::blue));
+
+        // too sparse, the runtime lookups are the SIMD scan
+        constexpr auto m3 = ctmap::make_map(
+             std::make_pair(-70000, 0)
+            ,std::make_pair(9, 1)
+            ,std::make_pair(1000, 2)
+            ,std::make_pair(-3, 3)
+            ,std::make_pair(123456, 4)
+        );
+        static_assert(!m3.storage().is_dense(), "");
+        static_assert(m3.find(1000).second == 2 && !m3.contains(10), "");
+        for ( const auto &it: m3 ) {
+            assert(m3.find(it.first).second == it.second);
+            assert(!m3.contains(it.first + 1));
+        }
+    }
+
+    {
+        constexpr auto m0 = make_soa_seq<std::int32_t, 7, -100>(std::make_index_sequence<40>{});
+        constexpr auto m1 = make_soa_seq<std::int32_t, 7, -1000>(std::make_index_sequence<300>{});
+        constexpr auto m2 = ctmap::make_map(
+             std::make_pair(1, 0)
+            ,std::make_pair(4, 1)
+            ,std::make_pair(2, 2)
+            ,std::make_pair(500, 3)
+            ,std::make_pair(3, 4)
+        );
+        constexpr auto m3 = ctmap::make_unordered_map(
+             std::make_pair(1, 0)
+            ,std::make_pair(4, 1)
+            ,std::make_pair(2, 2)
+            ,std::make_pair(500, 3)
+            ,std::make_pair(3, 4)
+        );
+        constexpr auto m4 = ctmap::make_eytzinger_map(
+             std::make_pair(1, 0)
+            ,std::make_pair(4, 1)
+            ,std::make_pair(2, 2)
+            ,std::make_pair(500, 3)
+            ,std::make_pair(3, 4)
+        );
+        constexpr auto m5 = ctmap::make_map_cmp(
+             pair_cmp_less{}
+            ,std::make_pair(1, 0)
+        );
+
+        constexpr auto batch = [](const auto &m) {
+            const int keys[3]{1, 7, 4};
+            ctmap::optional_t<int> out[3]{};
+            m.find_batch(keys, 3, out);
+            return out[0].first && out[0].second == 0 && !out[1].first && out[2].second == 1;
+        };
+        static_assert(batch(m2) && batch(m3) && batch(m4), "");
+        constexpr auto batch_span = [](const auto &m) {
+            const int keys[3]{1, 7, 4};
+            ctmap::optional_t<int> out[3]{};
+            m.find_batch({keys, keys + 3}, {out, out + 3});
+            return out[0].first && out[0].second == 0 && !out[1].first && out[2].second == 1;
+        };
+        static_assert(batch_span(m2) && batch_span(m3) && batch_span(m4), "");
+        {
+            const int keys[3]{1, 7, 4};
+            ctmap::optional_t<int> out[2]{};
+            bool thrown = false;
+            try {
+                m2.find_batch({keys, keys + 3}, {out, out + 2});
+            } catch (const std::length_error &) {
+                thrown = true;
+            }
+            assert(thrown);
+        }
+
+        std::vector<std::int32_t> keys;
+        for ( std::int32_t k = -1100; k < 1200; ++k ) {
+            keys.push_back(k);
+        }
+        const auto check = [&keys](const auto &m) {
+            std::vector<decltype(m.find(0))> out(keys.size());
+            m.find_batch(keys.begin(), keys.end(), out.begin());
+            for ( std::size_t i = 0; i < keys.size(); ++i ) {
+                assert(out[i] == m.find(keys[i]));
+            }
+        };
+        check(m0);
+        check(m1);
+        check(m2);
+        check(m3);
+        check(m4);
+        check(m5);
+    }
+
+    {
+        static constexpr auto m0 = ctmap::make_map(
+             std::make_pair(1, func)
+            ,std::make_pair(4, func)
+            ,std::make_pair(2, func)
+            ,std::make_pair(8, func)
+        );
+        static constexpr auto m1 = ctmap::make_soa_map(
+             std::make_pair(1, func)
+            ,std::make_pair(4, func)
+            ,std::make_pair(2, func)
+            ,std::make_pair(8, func)
+        );
+
+        static_assert(m0.find_ptr(4) == &m0[2].second, "");
+        static_assert(m0.find_ptr(3) == nullptr, "");
+        static_assert(m1.find_ptr(4) == &m1.storage().values()[2], "");
+        static_assert(m1.find_ptr(3) == nullptr, "");
+        static_assert(m0.find_it(8) == m0.begin() + 3 && m0.find_it(5) == m0.end(), "");
+        static_assert(m1.find_it(8) == m1.begin() + 3 && m1.find_it(5) == m1.end(), "");
+        static_assert(m0.at(2) == func && m1.at(2) == func, "");
+
+        static_assert(m0.lower_bound(0) == m0.begin(), "");
+        static_assert(m0.lower_bound(3)->first == 4, "");
+        static_assert(m0.lower_bound(4)->first == 4, "");
+        static_assert(m0.upper_bound(4)->first == 8, "");
+        static_assert(m0.lower_bound(9) == m0.end(), "");
+        static_assert(m1.lower_bound(3)->first == 4, "");
+        static_assert(m1.upper_bound(4)->first == 8, "");
+        static_assert(m1.upper_bound(8) == m1.end(), "");
+
+        constexpr auto r0 = m0.equal_range(2);
+        static_assert(r0.second - r0.first == 1 && r0.first->first == 2, "");
+        constexpr auto r1 = m1.equal_range(3);
+        static_assert(r1.first == r1.second, "");
+
+        bool thrown = false;
+        try {
+            (void)m0.at(3);
+        } catch (const std::out_of_range &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    {
+        using namespace std::literals;
+        static constexpr auto m = ctmap::make_string_map(
+             std::make_pair("Content-Type"sv, 0)
+            ,std::make_pair("Content-Length"sv, 1)
+            ,std::make_pair("Content-Encoding"sv, 2)
+            ,std::make_pair("Host"sv, 3)
+            ,std::make_pair("Accept"sv, 4)
+            ,std::make_pair("ab"sv, 5)
+            ,std::make_pair("ab\0"sv, 6)
+            ,std::make_pair("Content-"sv, 7)
+        );
+        static_assert(m.find("Content-Type"sv).second == 0, "");
+        static_assert(m.find("Content-Length"sv).second == 1, "");
+        static_assert(m.find("Content-Encoding"sv).second == 2, "");
+        static_assert(m.find("Host"sv).second == 3, "");
+        static_assert(m.find("Accept"sv).second == 4, "");
+        static_assert(m.find("ab"sv).second == 5, "");
+        static_assert(m.find("ab\0"sv).second == 6, "");
+        static_assert(m.find("Content-"sv).second == 7, "");
+        static_assert(!m.contains("Content"sv) && !m.contains("Content-Typ"sv) && !m.contains("a"sv), "");
+
+        for ( std::size_t i = 1; i < m.size(); ++i ) {
+            assert(m[i - 1].first < m[i].first);
+        }
+        for ( const auto &it: m ) {
+            const std::string key{it.first};
+            assert(m.find(std::string_view{key}).second == it.second);
+            assert(!m.contains(std::string_view{key + "x"}));
+        }
+    }
+
+    {
+        using namespace std::literals;
+        static constexpr auto m = ctmap::make_trie_map(
+             std::make_pair("GET"sv, 0)
+            ,std::make_pair("HEAD"sv, 1)
+            ,std::make_pair("POST"sv, 2)
+            ,std::make_pair("PUT"sv, 3)
+            ,std::make_pair("PATCH"sv, 4)
+            ,std::make_pair("P"sv, 5)
+            ,std::make_pair(""sv, 6)
+            ,std::make_pair("PUTS"sv, 7)
+        );
+        static_assert(m.find("GET"sv).second == 0, "");
+        static_assert(m.find("HEAD"sv).second == 1, "");
+        static_assert(m.find("POST"sv).second == 2, "");
+        static_assert(m.find("PUT"sv).second == 3, "");
+        static_assert(m.find("PATCH"sv).second == 4, "");
+        static_assert(m.find("P"sv).second == 5, "");
+        static_assert(m.find(""sv).second == 6, "");
+        static_assert(m.find("PUTS"sv).second == 7, "");
+        static_assert(!m.contains("PU"sv) && !m.contains("PUTT"sv) && !m.contains("GOT"sv), "");
+
+        static constexpr auto m1 = ctmap::make_trie_map(std::make_pair("one"sv, 1));
+        static_assert(m1.find("one"sv).second == 1 && !m1.contains("two"sv), "");
+
+        for ( const auto &it: m ) {
+            const std::string key{it.first};
+            assert(m.find(std::string_view{key}).second == it.second);
+            assert(!m.contains(std::string_view{key + "x"}));
+        }
+    }
+
+    // iterative introsort: duplicates, presorted, reversed and big inputs
+    {
+        struct check {
+            static constexpr bool sorted(std::size_t n, std::uint64_t mod, int order) {
+                std::array<std::uint32_t, 2000> a{};
+                ctmap::details::splitmix64 rnd{n};
+                for ( std::size_t i = 0; i < n; ++i ) {
+                    a[i] = order == 0
+                        ? static_cast<std::uint32_t>(rnd() % mod)
+                        : order > 0 ? static_cast<std::uint32_t>(i) : static_cast<std::uint32_t>(n - i)
+                    ;
+                }
+                ctmap::details::sort(a.begin(), a.begin() + n, std::less<std::uint32_t>{});
+                for ( std::size_t i = 1; i < n; ++i ) {
+                    if ( a[i] < a[i - 1] ) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+        };
+        static_assert(check::sorted(0, 1, 0) && check::sorted(1, 1, 0) && check::sorted(17, 5, 0), "");
+        static_assert(check::sorted(2000, 3, 0) && check::sorted(2000, 1u << 30, 0), "");
+        static_assert(check::sorted(2000, 0, 1) && check::sorted(2000, 0, -1), "");
+        assert(check::sorted(2000, 7, 0));
+    }
+
+    // the runtime built maps
+    {
+        std::vector<std::pair<std::uint32_t, int>> data;
+        std::map<std::uint32_t, int> ref;
+        for ( std::uint32_t i = 0; i < 1000; ++i ) {
+            const std::uint32_t k = i * 2654435761u;
+            data.emplace_back(k, static_cast<int>(i));
+            ref.emplace(k, static_cast<int>(i));
+        }
+
+        const ctmap::frozen_map<std::uint32_t, int> m0{data.begin(), data.end()};
+        const ctmap::frozen_unordered_map<std::uint32_t, int> m1{data};
+        const ctmap::frozen_eytzinger_map<std::uint32_t, int> m2{data};
+        assert(m0.size() == 1000 && m1.size() == 1000 && m2.size() == 1000);
+        assert(m0.equal(m1, std::equal_to<>{}) && m1.equal(m2, std::equal_to<>{}));
+
+        std::vector<std::uint32_t> keys;
+        for ( std::uint32_t i = 0; i < 2000; ++i ) {
+            keys.push_back((i % 2) ? (i / 2) * 2654435761u : i * 2654435761u + 1);
+        }
+        std::vector<ctmap::optional_t<int>> res0(keys.size()), res1(keys.size()), res2(keys.size());
+        m0.find_batch(keys.data(), keys.size(), res0.data());
+        m1.find_batch(keys.data(), keys.size(), res1.data());
+        m2.find_batch(keys.data(), keys.size(), res2.data());
+        for ( std::size_t i = 0; i < keys.size(); ++i ) {
+            const auto it = ref.find(keys[i]);
+            const bool found = it != ref.end();
+            assert(m0.contains(keys[i]) == found && m1.contains(keys[i]) == found && m2.contains(keys[i]) == found);
+            assert(res0[i].first == found && res1[i].first == found && res2[i].first == found);
+            if ( found ) {
+                assert(m0.at(keys[i]) == it->second && *m1.find_ptr(keys[i]) == it->second);
+                assert(m2.find(keys[i]).second == it->second && res1[i].second == it->second);
+            }
+        }
+        auto rit = ref.begin();
+        for ( const auto &it: m1 ) {
+            assert(it.first == rit->first && it.second == rit->second);
+            ++rit;
+        }
+
+        const std::map<std::string, int> smap{{"one", 1}, {"two", 2}, {"three", 3}};
+        const auto s0 = ctmap::make_frozen_map(smap.begin(), smap.end());
+        const ctmap::frozen_unordered_map<std::string, int> s1{{"one", 1}, {"two", 2}, {"three", 3}};
+        assert(s0.at("two") == 2 && s1.at("three") == 3 && !s0.contains("four") && !s1.contains("four"));
+
+        const ctmap::frozen_map<int, int> empty{std::vector<std::pair<int, int>>{}};
+        assert(empty.size() == 0 && !empty.contains(0) && empty.begin() == empty.end());
+
+        bool thrown = false;
+        try {
+            const ctmap::frozen_unordered_map<int, int> dup{{1, 1}, {2, 2}, {1, 3}};
+        } catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    // the serialized images
+    {
+        std::vector<std::pair<std::uint64_t, double>> data;
+        for ( std::uint64_t i = 0; i < 500; ++i ) {
+            data.emplace_back(i * 0x9e3779b97f4a7c15ull, static_cast<double>(i) / 2);
+        }
+        const ctmap::frozen_map<std::uint64_t, double> src{data};
+        const auto same = [](const auto &l, const auto &r) { return l.first == r.first && l.second == r.second; };
+
+        for ( const auto layout: {ctmap::image_layout::sorted, ctmap::image_layout::pmh, ctmap::image_layout::eytzinger} ) {
+            std::ostringstream os;
+            ctmap::write_image(os, src, layout);
+            const std::string image = os.str();
+
+            // the image must be 64-bytes aligned
+            std::vector<std::uint64_t> buf(image.size() / 8 + 16);
+            char *p = reinterpret_cast<char *>(buf.data());
+            p += (64 - reinterpret_cast<std::uintptr_t>(p) % 64) % 64;
+            std::memcpy(p, image.data(), image.size());
+
+            const ctmap::map_view<std::uint64_t, double> v{p, image.size()};
+            assert(v.layout() == layout && v.size() == src.size());
+            assert(v.equal(src, same));
+
+            std::vector<std::uint64_t> keys;
+            for ( const auto &it: data ) {
+                keys.push_back(it.first);
+                keys.push_back(it.first + 1);
+            }
+            std::vector<ctmap::optional_t<double>> res(keys.size());
+            v.find_batch(keys.data(), keys.size(), res.data());
+            for ( std::size_t i = 0; i < keys.size(); ++i ) {
+                assert(res[i].first == (i % 2 == 0) && v.contains(keys[i]) == (i % 2 == 0));
+                if ( i % 2 == 0 ) {
+                    assert(res[i].second == src.at(keys[i]) && v.at(keys[i]) == src.at(keys[i]));
+                }
+            }
+
+            bool thrown = false;
+            try {
+                const ctmap::map_view<std::uint32_t, double> bad{p, image.size()};
+            } catch (const std::runtime_error &) {
+                thrown = true;
+            }
+            assert(thrown);
+
+            // an index out of the range in the search tables is rejected on open
+            if ( layout != ctmap::image_layout::sorted ) {
+                ctmap::details::image_header h;
+                std::memcpy(&h, p, sizeof(h));
+                const std::uint32_t corrupted = 0xffffffffu;
+                std::memcpy(p + h.aux1 + sizeof(std::uint32_t), &corrupted, sizeof(corrupted));
+                thrown = false;
+                try {
+                    const ctmap::map_view<std::uint64_t, double> bad{p, image.size()};
+                } catch (const std::runtime_error &) {
+                    thrown = true;
+                }
+                assert(thrown);
+            }
+        }
+
+        // the keys without a hash: the sorted and Eytzinger layouts only
+        {
+            const ctmap::frozen_map<double, int> dsrc{{0.5, 1}, {-2.0, 2}, {8.25, 3}};
+            for ( const auto layout: {ctmap::image_layout::sorted, ctmap::image_layout::eytzinger} ) {
+                std::ostringstream os;
+                ctmap::write_image(os, dsrc, layout);
+                const std::string image = os.str();
+                std::vector<std::uint64_t> buf(image.size() / 8 + 16);
+                char *p = reinterpret_cast<char *>(buf.data());
+                p += (64 - reinterpret_cast<std::uintptr_t>(p) % 64) % 64;
+                std::memcpy(p, image.data(), image.size());
+                const ctmap::map_view<double, int> v{p, image.size()};
+                assert(v.equal(dsrc, same) && v.at(8.25) == 3 && !v.contains(1.0));
+            }
+
+            bool thrown = false;
+            try {
+                std::ostringstream os;
+                ctmap::write_image(os, dsrc, ctmap::image_layout::pmh);
+            } catch (const std::invalid_argument &) {
+                thrown = true;
+            }
+            assert(thrown);
+        }
+
+#if defined(CTMAP_HAS_MMAP)
+        const char *path = "ctmap-test.img";
+        {
+            std::ofstream os{path, std::ios::binary};
+            ctmap::write_image(os, src);
+        }
+        const auto v = ctmap::map_view<std::uint64_t, double>::open(path);
+        assert(v.layout() == ctmap::image_layout::pmh && v.equal(src, same));
+        std::remove(path);
+#endif
+    }
+
+    // adopting the presorted arrays
+    {
+        static constexpr std::array<std::pair<int, char>, 4> data{{{1, 'a'}, {3, 'b'}, {5, 'c'}, {7, 'd'}}};
+        static constexpr ctmap::map<4, int, char, ctmap::details::less_key<std::pair<int, char>>> m{ctmap::presorted, data};
+        static_assert(m.find(5).second == 'c' && !m.contains(4), "");
+        static constexpr ctmap::unordered_map<4, int, char> u{ctmap::presorted, data};
+        static_assert(u.find(7).second == 'd' && !u.contains(0), "");
+        static constexpr ctmap::map<1, int, char> m1{ctmap::presorted, std::array<std::pair<int, char>, 1>{{{1, 'a'}}}};
+        static_assert(m1.find(1).second == 'a', "");
+
+        bool thrown = false;
+        try {
+            const std::array<std::pair<int, char>, 3> unsorted{{{1, 'a'}, {5, 'c'}, {3, 'b'}}};
+            const ctmap::map<3, int, char> bad{ctmap::presorted, unsorted};
+        } catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    // the array factories
+    {
+        static constexpr std::array<std::pair<int, char>, 4> data{{{7, 'd'}, {1, 'a'}, {5, 'c'}, {3, 'b'}}};
+        static constexpr auto m0 = ctmap::make_map(data);
+        static_assert(m0.size() == 4 && m0.find(5).second == 'c' && !m0.contains(4), "");
+        static_assert(m0.begin()->first == 1, "");
+
+        static constexpr std::pair<std::string_view, int> names[] = {{"two", 2}, {"one", 1}, {"three", 3}};
+        static constexpr auto m1 = ctmap::make_map(names);
+        static_assert(m1.find("three").second == 3 && !m1.contains("four"), "");
+        static constexpr auto m2 = ctmap::make_map_cmp(pair_cmp_less{}, names);
+        static_assert(m2.find("one").second == 1, "");
+
+        static constexpr std::pair<int, int> sorted[] = {{-1, 1}, {0, 2}, {10, 3}};
+        static constexpr auto m3 = ctmap::make_map(ctmap::presorted, sorted);
+        static_assert(m3.find(10).second == 3 && m3.find(-1).second == 1, "");
+        static constexpr auto m4 = ctmap::make_map_cmp(pair_cmp_less{}, ctmap::presorted, ctmap::details::to_array(sorted));
+        static_assert(m4.find(0).second == 2, "");
+
+        static constexpr auto m5 = ctmap::make_unordered_map(data);
+        static constexpr auto m6 = ctmap::make_eytzinger_map(data);
+        static constexpr auto m7 = ctmap::make_soa_map(data);
+        static_assert(m5.find(7).second == 'd' && m6.find(7).second == 'd' && m7.find(7).second == 'd', "");
+        static constexpr std::array<std::pair<std::string_view, int>, 3> sdata{{{"b", 2}, {"a", 1}, {"c", 3}}};
+        static constexpr auto m8 = ctmap::make_string_map(sdata);
+        static constexpr auto m9 = ctmap::make_trie_map(sdata);
+        static_assert(m8.find("c").second == 3 && m9.find("a").second == 1 && !m9.contains("d"), "");
+
+        // an empty array makes an empty map
+        static constexpr auto m10 = ctmap::make_map(std::array<std::pair<int, char>, 0>{});
+        static_assert(m10.size() == 0 && !m10.contains(1) && m10.begin() == m10.end(), "");
+    }
+
+    // the duplicate keys
+    {
+        static constexpr std::array<std::pair<int, int>, 4> unique{{{3, 0}, {1, 1}, {2, 2}, {4, 3}}};
+        static constexpr std::array<std::pair<int, int>, 4> dups{{{3, 0}, {1, 1}, {3, 2}, {4, 3}}};
+        static_assert(ctmap::has_unique_keys(unique) && !ctmap::has_unique_keys(dups), "");
+
+        bool thrown = false;
+        try {
+            const ctmap::map<4, int, int> bad{dups};
+        } catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        assert(thrown);
+
+        thrown = false;
+        try {
+            const std::array<std::pair<int, int>, 3> sorted{{{1, 0}, {2, 1}, {2, 2}}};
+            const ctmap::map<3, int, int> bad{ctmap::presorted, sorted};
+        } catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    // the multimap
+    {
+        using namespace std::literals;
+        static constexpr auto m = ctmap::make_multimap(
+             std::make_pair("/users"sv, 1)
+            ,std::make_pair("/items"sv, 2)
+            ,std::make_pair("/users"sv, 3)
+            ,std::make_pair("/"sv, 4)
+            ,std::make_pair("/users"sv, 5)
+        );
+        static_assert(m.size() == 5, "");
+        static_assert(m.count("/users"sv) == 3 && m.count("/items"sv) == 1 && m.count("/none"sv) == 0, "");
+        static_assert(m.find("/users"sv).second == 1 && !m.contains("/none"sv), "");
+        static_assert(m.equal_range("/users"sv)[0] == 1 && m.equal_range("/users"sv)[2] == 5, "");
+        static_assert(m.equal_range("/none"sv).empty(), "");
+
+        int sum = 0;
+        for ( const int v: m.equal_range("/users"sv) ) {
+            sum = sum * 10 + v;
+        }
+        assert(sum == 135);
+        assert(m.begin()->first == "/"sv && (m.end() - 1)->first == "/users"sv);
+
+        static constexpr std::array<std::pair<int, char>, 6> data{{{2, 'a'}, {1, 'b'}, {2, 'c'}, {2, 'd'}, {0, 'e'}, {1, 'f'}}};
+        static constexpr auto m1 = ctmap::make_multimap(data);
+        static_assert(m1.count(2) == 3 && m1.equal_range(2)[1] == 'c' && m1.equal_range(1)[1] == 'f', "");
+    }
+
+    // the custom comparators and the transparent lookup
+    {
+        using namespace std::literals;
+        using ci_cmp = ctmap::details::less_key<std::pair<std::string_view, int>, ci_less>;
+        static constexpr auto m = ctmap::make_map_cmp(ci_cmp{}
+            ,std::make_pair("Content-Type"sv, 1)
+            ,std::make_pair("accept"sv, 2)
+            ,std::make_pair("HOST"sv, 3)
+        );
+        static_assert(m.find("content-type"sv).second == 1 && m.find("ACCEPT"sv).second == 2, "");
+        static_assert(m.find("Host").second == 3 && !m.contains("hosts"), "");
+        static_assert(m.begin()->first == "accept"sv && m.lower_bound("B")->first == "Content-Type"sv, "");
+        assert(m.at(std::string{"accepT"}) == 2);
+
+        // a comparator which is not aware of the keys, the search is still using its order
+        struct greater_first {
+            constexpr bool operator() (const std::pair<int, int> &l, const std::pair<int, int> &r) const noexcept
+            { return l.first > r.first; }
+        };
+        static constexpr auto g = ctmap::make_map_cmp(greater_first{}
+            ,std::make_pair(1, 10)
+            ,std::make_pair(3, 30)
+            ,std::make_pair(2, 20)
+        );
+        static_assert(g.begin()->first == 3 && g.find(1).second == 10 && g.find(3).second == 30 && !g.contains(4), "");
+        static_assert(g.lower_bound(2)->first == 2 && g.upper_bound(2)->first == 1, "");
+
+        // the transparent lookups of the `string_view` keys
+        static constexpr auto s = ctmap::make_map(std::make_pair("one"sv, 1), std::make_pair("two"sv, 2));
+        static_assert(s.find("two").second == 2 && s.contains("one") && !s.contains("three"), "");
+        const std::string key{"one"};
+        assert(s.find(key).second == 1 && s.find_ptr(key.c_str()) != nullptr);
+
+        const ctmap::frozen_unordered_map<std::string, int> f{{"one", 1}, {"two", 2}};
+        assert(f.find("two").second == 2 && f.find("two"sv).second == 2 && !f.contains("three"));
+
+        // the batch lookups are converting the keys the same as the single ones
+        static constexpr auto i = ctmap::make_map(std::make_pair(-1, 1), std::make_pair(0, 2), std::make_pair(5, 3));
+        const unsigned ukeys[] = {0xffffffffu, 0u, 5u, 6u};
+        ctmap::optional_t<int> ures[4];
+        i.find_batch(ukeys, 4, ures);
+        for ( std::size_t j = 0; j < 4; ++j ) {
+            assert(ures[j] == i.find(ukeys[j]));
+        }
+        assert(ures[0].first && ures[0].second == 1 && !ures[3].first);
+    }
+
+    {
+        // the compile-time dispatch over the integral and enum keys
+        static constexpr auto m = ctmap::make_map(
+             std::make_pair(1, func)
+            ,std::make_pair(4, func)
+            ,std::make_pair(2, func)
+        );
+        int res = 0;
+        assert(ctmap::dispatch<m>(4, [&res](auto f){ res = f(4); }) && res == 4);
+        assert(!ctmap::dispatch<m>(3, [&res](auto f){ res = f(3); }) && res == 4);
+        assert(ctmap::dispatch<m>(2, [](auto f){ return f(20); }, [](int){ return -1; }) == 20);
+        assert(ctmap::dispatch<m>(5, [](auto f){ return f(50); }, [](int k){ return -k; }) == -5);
+
+        // the sparse keys are taking the search path
+        static constexpr auto sparse = ctmap::make_map(
+             std::make_pair(-1000000, 1), std::make_pair(7, 2), std::make_pair(300, 3)
+            ,std::make_pair(4000, 4), std::make_pair(50000, 5), std::make_pair(600000, 6)
+        );
+        static_assert(!ctmap::details::dispatch_is_dense<sparse>(), "");
+        constexpr auto twice = [](int k) {
+            return ctmap::dispatch<sparse>(k, [](int v){ return v * 2; }, [](int){ return 0; });
+        };
+        static_assert(twice(-1000000) == 2 && twice(4000) == 8 && twice(600000) == 12 && twice(8) == 0, "");
+        assert(ctmap::dispatch<sparse>(50000, [&res](int v){ res = v; }) && res == 5);
+        assert(!ctmap::dispatch<sparse>(0, [&res](int v){ res = v; }) && res == 5);
+
+        static constexpr auto c = ctmap::make_map(
+             std::make_pair(color::red, 0u)
+            ,std::make_pair(color::black, 2u)
+            ,std::make_pair(color::green, 1u)
+        );
+        constexpr auto name = [](color k) {
+            return ctmap::dispatch<c>(k, [](unsigned v){ return v; }, [](color){ return 100u; });
+        };
+        static_assert(name(color::black) == 2 && name(color::green) == 1 && name(color::blue) == 100, "");
+
+        // the heterogeneous values, the map values are the indices into the tuple
+        constexpr auto get = [](color k) {
+            const std::tuple<int, char, long> t{1, 'b', 3};
+            return ctmap::visit<c>(k, t, [](auto v){ return v; }, [](color){ return -1; });
+        };
+        static_assert(std::is_same<decltype(get(color::red)), long>::value, "");
+        static_assert(get(color::red) == 1 && get(color::green) == 'b' && get(color::black) == 3 && get(color::blue) == -1, "");
+
+        std::tuple<int, std::string, double> t{1, "two", 3.0};
+        std::string out;
+        assert(ctmap::visit<c>(color::black, t, [&out](const auto &v){ std::ostringstream os; os << v; out = os.str(); }));
+        assert(out == "3");
+        assert(ctmap::visit<c>(color::green, t, [&out](const auto &v){ std::ostringstream os; os << v; out = os.str(); }));
+        assert(out == "two");
+    }
+
+    {
+        // the lookup statistics
+        struct stats_tag;
+        static constexpr auto m = ctmap::with_stats<ctmap::counting_stats<stats_tag>>(ctmap::make_map(
+             std::make_pair(1, 10)
+            ,std::make_pair(2, 20)
+            ,std::make_pair(3, 30)
+        ));
+        static_assert(m.find(2).second == 20, "");
+        static constexpr auto s = ctmap::with_stats<ctmap::counting_stats<stats_tag>>(
+            ctmap::make_map_cmp(pair_cmp_less{}, std::make_pair(1, 10), std::make_pair(2, 20))
+        );
+
+        for ( int i = 0; i < 10; ++i ) {
+            assert(m.find(3).second == 30);
+        }
+        assert(m.contains(1) && m.find_ptr(1) && !m.contains(4));
+        int keys[] = {3, 5, 2};
+        ctmap::optional_t<int> out[3]{};
+        m.find_batch(keys, 3, out);
+        assert(s.find(2).second == 20);
+
+        // the dense map takes one probe per lookup
+        auto st = ctmap::get_stats(m);
+        assert(st.lookups == 16 && st.misses == 2 && st.probes == 16 && st.miss_probes == 2);
+        assert(st.hits.size() == 3 && st.hits[0].key == 3 && st.hits[0].hits == 11 && st.hits[0].probes == 11);
+        assert(st.hits[1].key == 1 && st.hits[1].hits == 2 && st.hits[2].key == 2 && st.hits[2].hits == 1);
+        // the binary search over two keys: two compares and the equivalence test
+        const auto ss = ctmap::get_stats(s);
+        assert(ss.lookups == 1 && ss.hits.size() == 1 && ss.hits[0].probes == 3 && ss.probes == 3);
+
+        std::ostringstream os;
+        ctmap::dump_stats(m, os);
+        assert(os.str().compare(0, 42, "lookups=16 hits=14 misses=2 probes/lookup=") == 0);
+        ctmap::reset_stats(m);
+        assert(ctmap::get_stats(m).lookups == 0 && ctmap::get_stats(s).lookups == 1);
+    }
+
+    {
+        // the hot keys first
+        using namespace std::literals;
+        static constexpr auto m = ctmap::make_weighted_map<2>({5, 900, 2, 80, 1, 1, 10}
+            ,std::make_pair("PUT"sv, 3)
+            ,std::make_pair("GET"sv, 1)
+            ,std::make_pair("PATCH"sv, 6)
+            ,std::make_pair("POST"sv, 2)
+            ,std::make_pair("TRACE"sv, 8)
+            ,std::make_pair("CONNECT"sv, 9)
+            ,std::make_pair("DELETE"sv, 4)
+        );
+        // GET and POST are scanned, at most two of them
+        static_assert(m.storage().hot_size() == 2, "");
+        constexpr auto probes = [](const auto &s, const auto &k) {
+            std::size_t n = 0;
+            s.find_index_probes(k, n);
+            return n;
+        };
+        static_assert(probes(m.storage(), "GET"sv) == 1 && probes(m.storage(), "POST"sv) == 2, "");
+        static_assert(probes(m.storage(), "TRACE"sv) > 2, "");
+        static_assert(m.find("GET").second == 1 && m.find("POST").second == 2 && m.find("TRACE").second == 8, "");
+        static_assert(!m.contains("HEAD") && m.begin()->first == "CONNECT"sv, "");
+        for ( const auto &it: m ) {
+            assert(m.find(it.first).second == it.second);
+        }
+
+        // the uniform weights are not worth the scan
+        constexpr auto arr = [] {
+            std::array<std::pair<int, int>, 16> res{};
+            for ( int i = 0; i < 16; ++i ) {
+                res[i].first = 15 - i;
+                res[i].second = (15 - i) * 10;
+            }
+            return res;
+        }();
+        std::array<std::uint64_t, 16> weights{};
+        weights.fill(1);
+        const auto u = ctmap::make_weighted_map(arr, weights);
+        assert(u.storage().hot_size() == 0 && u.find(3).second == 30 && !u.contains(16));
+        weights[7] = 100;
+        const auto h = ctmap::make_weighted_map(arr, weights);
+        assert(h.storage().hot_size() == 1 && h.find(8).second == 80 && h.find(0).second == 0);
+    }
+
+    {
+        // the compressed keys
+        static constexpr auto m = ctmap::make_compressed_map<std::uint16_t, 4>(
+             std::make_pair(std::int64_t{-5}, 1)
+            ,std::make_pair(std::int64_t{100}, 2)
+            ,std::make_pair(std::int64_t{7}, 3)
+            ,std::make_pair(std::int64_t{60000}, 4)
+            ,std::make_pair(std::int64_t{60001}, 5)
+            ,std::make_pair(std::int64_t{90000}, 6)
+        );
+        static_assert(m.find(-5).second == 1 && m.find(100).second == 2 && m.find(60001).second == 5, "");
+        static_assert(m.find(90000).second == 6 && !m.contains(-6) && !m.contains(8) && !m.contains(90001), "");
+        static_assert(m.begin()->first == -5 && (m.end() - 1)->first == 90000 && m.lower_bound(50)->first == 100, "");
+
+        constexpr auto arr = [] {
+            std::array<std::pair<std::uint64_t, std::uint32_t>, 1000> res{};
+            for ( std::size_t i = 0; i < res.size(); ++i ) {
+                res[i].first = i * 997 + (1ull << 40);
+                res[i].second = static_cast<std::uint32_t>(i);
+            }
+            return res;
+        }();
+        static constexpr auto c = ctmap::make_compressed_map(ctmap::presorted, arr);
+        static_assert(sizeof(c) * 2 < sizeof(ctmap::map<1000, std::uint64_t, std::uint32_t>), "");
+        for ( const auto &it: arr ) {
+            assert(c.find(it.first).second == it.second && !c.contains(it.first + 1));
+        }
+        std::size_t i = 0;
+        for ( const auto &it: c ) {
+            assert(it.first == arr[i].first && it.second == arr[i].second);
+            ++i;
+        }
+
+        // the gap within a block is too wide for the 16 bits
+        bool thrown = false;
+        try {
+            ctmap::make_compressed_map(std::array<std::pair<int, int>, 2>{{{0, 0}, {70000, 1}}});
+        } catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    {
+        // the deduplicated values
+        using namespace std::literals;
+        static constexpr std::array<std::pair<std::string_view, int(*)(int)>, 6> table{{
+             {"run"sv, func}
+            ,{"exec"sv, func}
+            ,{"start"sv, func}
+            ,{"stop"sv, nullptr}
+            ,{"halt"sv, nullptr}
+            ,{"go"sv, func}
+        }};
+        static constexpr auto m = ctmap::make_dedup_map<table>();
+        static_assert(m.storage().distinct() == 2, "");
+        static_assert(sizeof(m) < sizeof(ctmap::map<6, std::string_view, int(*)(int)>), "");
+        static_assert(m.find("start").second == func && m.find("halt").second == nullptr && !m.contains("walk"), "");
+        static_assert(m.begin()->first == "exec"sv && m.begin()->second == func, "");
+        assert(m.at("go")(7) == 7 && m.find_ptr("run") == m.find_ptr("exec"));
+        for ( const auto &it: table ) {
+            assert(m.find(it.first).second == it.second);
+        }
+
+        // more distinct values than declared
+        bool thrown = false;
+        try {
+            ctmap::dedup_map<3, int, int, 2> d{std::array<std::pair<int, int>, 3>{{{1, 1}, {2, 2}, {3, 3}}}};
+        } catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    {
+        // the sets
+        using namespace std::literals;
+        static constexpr auto ops = ctmap::make_bitmask_set<64>('+', '-', '*', '/', '%', '<', '>', '=');
+        static_assert(ops.size() == 8 && ops.contains('+') && ops.contains('>') && !ops.contains('a') && !ops.contains('\0'), "");
+        static_assert(*ops.find('-') == '-' && ops.find('a') == ops.end() && ops[0] == '%', "");
+        for ( const char c: ops ) {
+            assert(ops.contains(c) && *ops.find(c) == c);
+        }
+
+        static constexpr auto colors = ctmap::make_bitmask_set(color::black, color::red);
+        static_assert(colors.contains(color::black) && !colors.contains(color::blue), "");
+
+        static constexpr auto kw = ctmap::make_set("if"sv, "else"sv, "while"sv);
+        static_assert(kw.contains("while") && !kw.contains("for") && *kw.lower_bound("f") == "if"sv, "");
+        assert(kw.contains(std::string{"else"}) && kw.count("if") == 1);
+
+        static constexpr auto h = ctmap::make_unordered_set(10, 20, 30, 1000);
+        static_assert(h.contains(1000) && !h.contains(11) && h.count(20) == 1 && h.count(21) == 0, "");
+
+        // the widening keys are converted, the narrowing ones are rejected
+        static constexpr auto wide = ctmap::make_set(1L, 2, 3);
+        static_assert(wide.contains(2L) && !wide.contains(4L), "");
+        static_assert(!ctmap::details::is_brace_convertible<unsigned, int>::value, "");
+        static_assert(!ctmap::details::is_brace_convertible<std::uint8_t, int>::value, "");
+        static_assert(ctmap::details::is_brace_convertible<long, int>::value, "");
+
+        // the keys range is wider than the bitmask
+        bool thrown = false;
+        try {
+            ctmap::make_bitmask_set<64>(std::array<int, 2>{{0, 64}});
+        } catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    {
+        // the intervals
+        enum class port_class { system, registered, dynamic };
+        static constexpr auto ports = ctmap::make_interval_map(
+             std::make_pair(std::make_pair(1024, 49152), port_class::registered)
+            ,std::make_pair(std::make_pair(0, 1024), port_class::system)
+            ,std::make_pair(std::make_pair(49152, 65536), port_class::dynamic)
+        );
+        static_assert(ports.find(0).second == port_class::system && ports.find(1023).second == port_class::system, "");
+        static_assert(ports.find(1024).second == port_class::registered && ports.at(65535) == port_class::dynamic, "");
+        static_assert(!ports.contains(65536) && !ports.contains(-1) && ports.begin()->first.first == 0, "");
+        assert(ports.find(8080).second == port_class::registered && ports.find_ptr(70000) == nullptr);
+
+        // the gaps, and the S-tree search of the big tables
+        constexpr auto arr = [] {
+            std::array<std::pair<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t>, 1000> res{};
+            for ( std::uint32_t i = 0; i < res.size(); ++i ) {
+                res[i].first.first = i * 10 + 5;
+                res[i].first.second = i * 10 + 10;
+                res[i].second = i;
+            }
+            return res;
+        }();
+        const auto big = std::make_unique<const ctmap::interval_map<1000, std::uint32_t, std::uint32_t>>(arr);
+        for ( std::uint32_t k = 0; k < 10020; ++k ) {
+            const bool inside = k >= 5 && k < 10005 && k % 10 >= 5;
+            const auto r = big->find(k);
+            assert(r.first == inside && (!inside || r.second == (k - 5) / 10));
+        }
+
+        bool thrown = false;
+        try {
+            ctmap::make_interval_map(std::make_pair(std::make_pair(0, 5), 1), std::make_pair(std::make_pair(4, 8), 2));
+        } catch (const std::invalid_argument &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
     return 0;
 }
 
@@ -0,0 +1,102 @@
+# fails when the constexpr build cost of a map grows superlinearly with its size.
+#
+# usage:
+#   cmake -DCXX=<compiler> -DMEASURE=<ctmap-measure> -DSOURCE=<table.cpp>
+#         -DINCLUDE_DIR=<dir> -DSTEPS_FLAG=<-fconstexpr-ops-limit=|-fconstexpr-steps=>
+#         -DSIZES="1000;4000;16000" -DMAX_GROWTH=5 -DMAX_TIME_GROWTH=6 -DRUNS=3 -DWORK_DIR=<dir> -P compile-growth.cmake
+#
+# every size is compiled RUNS times (3 by default) and the least CPU time and memory are taken, then
+# the cost of an one-entry table (the compiler start and the headers) is subtracted from them.
+# the SIZES are growing by the same factor, and between the neighbours the time and the memory
+# must not grow by more than MAX_GROWTH times: with the step of 4, the N*log(N) of the sort is
+# about 4.6, and the default of 5 fails the N^1.25 (5.7) and anything steeper. the time is the
+# CPU time, it still jitters by 20% on a loaded machine, so it has its own MAX_TIME_GROWTH
+# (6 by default), which fails the N^1.5 (8).
+
+foreach(var CXX MEASURE SOURCE INCLUDE_DIR SIZES WORK_DIR)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "compile-growth.cmake: ${var} is not set")
+    endif()
+endforeach()
+if(NOT DEFINED MAX_GROWTH)
+    set(MAX_GROWTH 5)
+endif()
+if(NOT DEFINED MAX_TIME_GROWTH)
+    set(MAX_TIME_GROWTH 6)
+endif()
+if(NOT DEFINED RUNS)
+    set(RUNS 3)
+endif()
+
+set(OUT "${WORK_DIR}/growth-table.o")
+
+function(compile_table n time_var rss_var)
+    set(args -std=c++17 -I${INCLUDE_DIR} -DCTMAP_BENCH_N=${n})
+    if(STEPS_FLAG)
+        list(APPEND args ${STEPS_FLAG}4294967296)
+    endif()
+    set(best_time "")
+    set(best_rss "")
+    foreach(run RANGE 1 ${RUNS})
+        execute_process(
+            COMMAND ${MEASURE} ${CXX} ${args} -c ${SOURCE} -o ${OUT}
+            RESULT_VARIABLE res
+            OUTPUT_VARIABLE out
+            ERROR_QUIET
+        )
+        if(NOT res EQUAL 0)
+            message(FATAL_ERROR "compile-growth.cmake: N=${n} does not compile")
+        endif()
+        string(REGEX MATCH "cpu_ms=([0-9]+)" _ "${out}")
+        if(best_time STREQUAL "" OR CMAKE_MATCH_1 LESS best_time)
+            set(best_time ${CMAKE_MATCH_1})
+        endif()
+        string(REGEX MATCH "maxrss_kb=([0-9]+)" _ "${out}")
+        if(best_rss STREQUAL "" OR CMAKE_MATCH_1 LESS best_rss)
+            set(best_rss ${CMAKE_MATCH_1})
+        endif()
+    endforeach()
+    set(${time_var} ${best_time} PARENT_SCOPE)
+    set(${rss_var} ${best_rss} PARENT_SCOPE)
+endfunction()
+
+compile_table(1 base_time base_rss)
+message(STATUS "N=1: time=${base_time}ms maxrss=${base_rss}KB")
+
+set(failed FALSE)
+set(prev_n "")
+foreach(n ${SIZES})
+    compile_table(${n} time rss)
+    # at least 1, the small tables may take less than the noise
+    math(EXPR dtime "${time} - ${base_time}")
+    math(EXPR drss "${rss} - ${base_rss}")
+    if(dtime LESS 1)
+        set(dtime 1)
+    endif()
+    if(drss LESS 1)
+        set(drss 1)
+    endif()
+
+    set(verdict "")
+    if(prev_n)
+        math(EXPR time_limit "${prev_dtime} * ${MAX_TIME_GROWTH}")
+        math(EXPR rss_limit "${prev_drss} * ${MAX_GROWTH}")
+        if(dtime GREATER time_limit)
+            set(failed TRUE)
+            string(APPEND verdict " time grew more than ${MAX_TIME_GROWTH}x from N=${prev_n}")
+        endif()
+        if(drss GREATER rss_limit)
+            set(failed TRUE)
+            string(APPEND verdict " memory grew more than ${MAX_GROWTH}x from N=${prev_n}")
+        endif()
+    endif()
+    message(STATUS "N=${n}: time=+${dtime}ms maxrss=+${drss}KB${verdict}")
+
+    set(prev_n ${n})
+    set(prev_dtime ${dtime})
+    set(prev_drss ${drss})
+endforeach()
+
+if(failed)
+    message(FATAL_ERROR "compile-growth.cmake: superlinear growth of the build cost")
+endif()
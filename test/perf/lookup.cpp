@@ -0,0 +1,328 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// the lookup cost regression test:
+//   ctmap-perf-lookup <baseline> [--update] [--tolerance=<fraction>]
+// every lookup path is timed with the fixed seeds, as the best of several runs, and divided by
+// the time of `std::lower_bound` over 48 keys which stay in L1: the ratios are much less
+// dependent on the machine than the nanoseconds. the test fails when a ratio exceeds its baseline
+// by more than the tolerance (0.3 by default) in each of the three attempts, so a single noisy
+// run is not a regression. `--update` writes the median ratios of three attempts as the baseline.
+
+#include <ctmap/ctmap.hpp>
+
+#include "do_not_optimize.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*************************************************************************************************/
+
+static constexpr std::size_t num_queries = 4096;
+static constexpr std::size_t num_rounds = 200;
+static constexpr std::size_t num_runs = 7;
+static constexpr std::size_t num_attempts = 3;
+
+// the best of the runs, in ns per lookup
+template<typename Q, typename F>
+double measure(const std::vector<Q> &queries, F &&f) {
+    double best = 0;
+    std::size_t sink = 0;
+    for ( std::size_t run = 0; run < num_runs; ++run ) {
+        const auto start = std::chrono::steady_clock::now();
+        for ( std::size_t r = 0; r < num_rounds; ++r ) {
+            for ( const auto &q: queries ) {
+                sink += f(q);
+            }
+        }
+        const auto stop = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(stop - start).count()
+            / static_cast<double>(num_rounds * queries.size());
+        best = (run == 0 || ns < best) ? ns : best;
+    }
+    do_not_optimize(sink);
+
+    return best;
+}
+
+template<typename Map, typename K>
+std::uint32_t find_or_zero(const Map &m, const K &k) noexcept {
+    const auto r = m.find(k);
+    return r.first ? static_cast<std::uint32_t>(r.second) : 0u;
+}
+
+struct result {
+    std::string name;
+    double ns;
+    double ratio;
+};
+
+/*************************************************************************************************/
+
+// sparse, unique keys: an odd multiplier is a bijection modulo 2^32
+constexpr std::uint32_t int_key(std::size_t i) noexcept
+{ return static_cast<std::uint32_t>(i * 2654435761u); }
+
+// the ns/lookup every result is divided by
+double reference() {
+    constexpr std::size_t N = 48;
+    std::vector<std::uint32_t> keys(N);
+    for ( std::size_t i = 0; i < N; ++i ) {
+        keys[i] = int_key(i);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    ctmap::details::splitmix64 rnd{N};
+    std::vector<std::uint32_t> queries;
+    for ( std::size_t i = 0; i < num_queries; ++i ) {
+        const auto key = int_key(rnd() % N);
+        queries.push_back(i % 2 ? key : key + 1);
+    }
+
+    return measure(queries, [&keys](std::uint32_t k) {
+        const auto it = std::lower_bound(keys.begin(), keys.end(), k);
+        return (it != keys.end() && *it == k) ? static_cast<std::uint32_t>(it - keys.begin()) : 0u;
+    });
+}
+
+template<std::size_t N>
+void bench_ints(std::vector<result> &results, double ref) {
+    using pair_type = std::pair<std::uint32_t, std::uint32_t>;
+    using cmp = ctmap::details::less_key<pair_type>;
+
+    auto data = std::make_unique<std::array<pair_type, N>>();
+    auto dense = std::make_unique<std::array<pair_type, N>>();
+    for ( std::size_t i = 0; i < N; ++i ) {
+        (*data)[i] = {int_key(i), static_cast<std::uint32_t>(i)};
+        (*dense)[i] = {static_cast<std::uint32_t>(i + i / 2), static_cast<std::uint32_t>(i)};
+    }
+    const auto sorted = std::make_unique<const ctmap::map<N, std::uint32_t, std::uint32_t, cmp>>(*data);
+    const auto soa = std::make_unique<const ctmap::soa_map<N, std::uint32_t, std::uint32_t>>(*data);
+    const auto eytzinger = std::make_unique<const ctmap::eytzinger_map<N, std::uint32_t, std::uint32_t>>(*data);
+    const auto unordered = std::make_unique<const ctmap::unordered_map<N, std::uint32_t, std::uint32_t>>(*data);
+    const auto dense_map = std::make_unique<const ctmap::details::default_map_t<N, std::uint32_t, std::uint32_t>>(*dense);
+
+    // the half of the queries are misses
+    ctmap::details::splitmix64 rnd{N};
+    std::vector<std::uint32_t> queries;
+    std::vector<std::uint32_t> dense_queries;
+    for ( std::size_t i = 0; i < num_queries; ++i ) {
+        const auto key = int_key(rnd() % N);
+        queries.push_back(i % 2 ? key : key + 1);
+        dense_queries.push_back(static_cast<std::uint32_t>(rnd() % (N + N / 2)));
+    }
+
+    const auto add = [&results, ref](const char *name, double ns) {
+        char full[64];
+        std::snprintf(full, sizeof(full), "%s/%zu", name, N);
+        results.push_back({full, ns, ns / ref});
+    };
+
+    add("sorted_vector", measure(queries, [&m = *sorted](std::uint32_t k) { return find_or_zero(m, k); }));
+    add("sorted_vector.lower_bound", measure(queries, [&m = *sorted](std::uint32_t k) {
+        // a miss past the largest key is at the end
+        const auto it = m.lower_bound(k);
+        return it != m.end() ? it->second : 0u;
+    }));
+    add("soa_storage", measure(queries, [&m = *soa](std::uint32_t k) { return find_or_zero(m, k); }));
+    add("eytzinger_storage", measure(queries, [&m = *eytzinger](std::uint32_t k) { return find_or_zero(m, k); }));
+    add("pmh_storage", measure(queries, [&m = *unordered](std::uint32_t k) { return find_or_zero(m, k); }));
+    add("dense_storage", measure(dense_queries, [&m = *dense_map](std::uint32_t k) { return find_or_zero(m, k); }));
+}
+
+void bench_strings(std::vector<result> &results, double ref) {
+    constexpr std::size_t N = 300;
+    using pair_type = std::pair<std::string_view, std::uint32_t>;
+
+    std::vector<std::string> names(N);
+    ctmap::details::splitmix64 rnd{N};
+    for ( std::size_t i = 0; i < N; ++i ) {
+        const std::size_t len = 3 + rnd() % 10;
+        for ( std::size_t j = 0; j < len; ++j ) {
+            names[i] += static_cast<char>('a' + rnd() % 26);
+        }
+        names[i] += std::to_string(i);
+    }
+    std::array<pair_type, N> data{};
+    for ( std::size_t i = 0; i < N; ++i ) {
+        data[i] = {names[i], static_cast<std::uint32_t>(i)};
+    }
+    const auto sorted = std::make_unique<const ctmap::map<N, std::string_view, std::uint32_t>>(data);
+    const auto unordered = std::make_unique<const ctmap::unordered_map<N, std::string_view, std::uint32_t>>(data);
+    const auto string = std::make_unique<const ctmap::string_map<N, std::uint32_t>>(data);
+
+    // the misses are the names with the last char changed
+    std::vector<std::string> misses(names);
+    for ( auto &it: misses ) {
+        it.back() = '_';
+    }
+    std::vector<std::string_view> queries;
+    for ( std::size_t i = 0; i < num_queries; ++i ) {
+        const std::size_t idx = rnd() % N;
+        queries.push_back(i % 2 ? std::string_view{names[idx]} : std::string_view{misses[idx]});
+    }
+
+    const auto add = [&results, ref](const char *name, double ns) {
+        char full[64];
+        std::snprintf(full, sizeof(full), "%s/string/%zu", name, N);
+        results.push_back({full, ns, ns / ref});
+    };
+
+    add("sorted_vector", measure(queries, [&m = *sorted](std::string_view k) { return find_or_zero(m, k); }));
+    add("pmh_storage", measure(queries, [&m = *unordered](std::string_view k) { return find_or_zero(m, k); }));
+    add("string_storage", measure(queries, [&m = *string](std::string_view k) { return find_or_zero(m, k); }));
+}
+
+/*************************************************************************************************/
+
+std::map<std::string, double> read_baseline(const char *path) {
+    std::map<std::string, double> res;
+    std::ifstream file{path};
+    std::string line;
+    while ( std::getline(file, line) ) {
+        if ( line.empty() || line[0] == '#' ) {
+            continue;
+        }
+        std::istringstream is{line};
+        std::string name;
+        double ratio = 0;
+        if ( is >> name >> ratio ) {
+            res[name] = ratio;
+        }
+    }
+
+    return res;
+}
+
+int main(int argc, char **argv) {
+    if ( argc < 2 ) {
+        std::fprintf(stderr, "usage: %s <baseline> [--update] [--tolerance=<fraction>]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *baseline_path = argv[1];
+    bool update = false;
+    double tolerance = 0.3;
+    for ( int i = 2; i < argc; ++i ) {
+        if ( std::strcmp(argv[i], "--update") == 0 ) {
+            update = true;
+        } else if ( std::strncmp(argv[i], "--tolerance=", 12) == 0 ) {
+            tolerance = std::atof(argv[i] + 12);
+        } else {
+            std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto run_all = [] {
+        std::vector<result> results;
+        const double ref = reference();
+        bench_ints<48>(results, ref);
+        bench_ints<4096>(results, ref);
+        bench_ints<65536>(results, ref);
+        bench_strings(results, ref);
+        return results;
+    };
+
+    if ( update ) {
+        std::vector<std::vector<result>> attempts;
+        for ( std::size_t attempt = 0; attempt < num_attempts; ++attempt ) {
+            attempts.push_back(run_all());
+        }
+        std::ofstream file{baseline_path};
+        file << "# <lookup path> <ns/lookup divided by the ns/lookup of std::lower_bound over 48 keys>\n";
+        for ( std::size_t i = 0; i < attempts.front().size(); ++i ) {
+            std::vector<double> ratios;
+            for ( const auto &it: attempts ) {
+                ratios.push_back(it[i].ratio);
+            }
+            std::sort(ratios.begin(), ratios.end());
+            file << attempts.front()[i].name << ' ' << ratios[ratios.size() / 2] << '\n';
+        }
+        std::printf("the baseline is written to %s\n", baseline_path);
+        return file ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const auto baseline = read_baseline(baseline_path);
+    if ( baseline.empty() ) {
+        std::fprintf(stderr, "no baseline in %s, run with --update\n", baseline_path);
+        return EXIT_FAILURE;
+    }
+
+    // the best ratio of every lookup over the attempts
+    std::vector<result> results;
+    int failed = 0;
+    for ( std::size_t attempt = 0; attempt < num_attempts; ++attempt ) {
+        const auto current = run_all();
+        if ( results.empty() ) {
+            results = current;
+        } else {
+            for ( std::size_t i = 0; i < results.size(); ++i ) {
+                if ( current[i].ratio < results[i].ratio ) {
+                    results[i] = current[i];
+                }
+            }
+        }
+
+        failed = 0;
+        for ( const auto &it: results ) {
+            const auto base = baseline.find(it.name);
+            failed += (base != baseline.end() && it.ratio > base->second * (1 + tolerance));
+        }
+        if ( !failed ) {
+            break;
+        }
+    }
+
+    std::printf("%-36s %10s %10s %10s\n", "lookup", "ns", "ratio", "baseline");
+    for ( const auto &it: results ) {
+        const auto base = baseline.find(it.name);
+        if ( base == baseline.end() ) {
+            std::printf("%-36s %10.2f %10.3f %10s\n", it.name.c_str(), it.ns, it.ratio, "-");
+            continue;
+        }
+        const bool regressed = it.ratio > base->second * (1 + tolerance);
+        std::printf("%-36s %10.2f %10.3f %10.3f%s\n"
+            ,it.name.c_str()
+            ,it.ns
+            ,it.ratio
+            ,base->second
+            ,(regressed ? "  REGRESSED" : "")
+        );
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*************************************************************************************************/
@@ -0,0 +1,61 @@
+# the `ctmap_generate_table()` function: generates a header with a presorted
+# constexpr ctmap table from a key/value file at build time.
+#
+#   include(<ctmap>/tools/ctmap-gen/ctmap-gen.cmake)
+#   ctmap_generate_table(
+#        TARGET     <target>        # the generated header is added to its sources and include directories
+#        INPUT      <file>          # relative to CMAKE_CURRENT_SOURCE_DIR
+#        OUTPUT     <header>        # relative to CMAKE_CURRENT_BINARY_DIR
+#        NAME       <identifier>
+#        KEY_TYPE   <C++ type|string>
+#        VALUE_TYPE <C++ type|string>
+#       [NAMESPACE  <ns>]
+#       [STORAGE    map|unordered|eytzinger|soa|string|trie]
+#       [DELIMITER  <char>]
+#   )
+#
+# the `ctmap-gen` host tool is built once, on the first call.
+
+set(CTMAP_GEN_SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+function(ctmap_generate_table)
+    cmake_parse_arguments(ARG ""
+        "TARGET;INPUT;OUTPUT;NAME;KEY_TYPE;VALUE_TYPE;NAMESPACE;STORAGE;DELIMITER" "" ${ARGN})
+    foreach(arg TARGET INPUT OUTPUT NAME KEY_TYPE VALUE_TYPE)
+        if(NOT ARG_${arg})
+            message(FATAL_ERROR "ctmap_generate_table(): ${arg} is required")
+        endif()
+    endforeach()
+
+    if(NOT TARGET ctmap-gen)
+        add_executable(ctmap-gen ${CTMAP_GEN_SOURCE_DIR}/main.cpp)
+        set_target_properties(ctmap-gen PROPERTIES CXX_STANDARD 17 CXX_STANDARD_REQUIRED ON)
+    endif()
+
+    get_filename_component(input ${ARG_INPUT} ABSOLUTE BASE_DIR ${CMAKE_CURRENT_SOURCE_DIR})
+    get_filename_component(output ${ARG_OUTPUT} ABSOLUTE BASE_DIR ${CMAKE_CURRENT_BINARY_DIR})
+    get_filename_component(output_dir ${output} DIRECTORY)
+
+    set(args --input ${input} --output ${output} --name ${ARG_NAME}
+        --key-type ${ARG_KEY_TYPE} --value-type ${ARG_VALUE_TYPE})
+    if(ARG_NAMESPACE)
+        list(APPEND args --namespace ${ARG_NAMESPACE})
+    endif()
+    if(ARG_STORAGE)
+        list(APPEND args --storage ${ARG_STORAGE})
+    endif()
+    if(ARG_DELIMITER)
+        list(APPEND args --delimiter ${ARG_DELIMITER})
+    endif()
+
+    add_custom_command(
+        OUTPUT ${output}
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${output_dir}
+        COMMAND ctmap-gen ${args}
+        DEPENDS ${input} ctmap-gen
+        COMMENT "Generating the ctmap table ${ARG_NAME}"
+        VERBATIM
+    )
+    target_sources(${ARG_TARGET} PRIVATE ${output})
+    target_include_directories(${ARG_TARGET} PRIVATE ${output_dir})
+endfunction()
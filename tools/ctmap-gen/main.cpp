@@ -0,0 +1,353 @@
+
+// ----------------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2024-2024 niXman (github dot nixman at pm dot me)
+// This file is part of ctmap(github.com/niXman/ctmap) project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// emits a header with a presorted constexpr table for `ctmap`, so the compiler does not have
+// to sort (or even to forward as a parameter pack) the elements.
+//
+// usage:
+//   ctmap-gen --input <file> --output <header> --name <identifier>
+//             --key-type <C++ type|string> --value-type <C++ type|string>
+//             [--namespace <ns>] [--storage map|unordered|eytzinger|soa|string|trie]
+//             [--delimiter <char>]
+//
+// the input has one `key<delimiter>value` pair per line, the empty lines and the lines
+// starting with `#` are skipped. a field can be double quoted, a quote inside is doubled.
+// the `string` type emits the field as a `std::string_view` literal, any other type emits
+// the field verbatim, so the numbers (including hex) and C++ expressions can be used.
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*************************************************************************************************/
+
+struct options {
+    std::string input;
+    std::string output;
+    std::string name;
+    std::string key_type;
+    std::string value_type;
+    std::string ns;
+    std::string storage = "map";
+    char delimiter = ',';
+};
+
+struct entry {
+    std::string key;
+    std::string value;
+    std::size_t line;
+    // the numeric keys are ordered by value, the negative ones are kept as signed
+    bool negative;
+    std::uint64_t bits;
+};
+
+/*************************************************************************************************/
+
+static std::string trim(const std::string &s) {
+    const auto b = s.find_first_not_of(" \t\r");
+    if ( b == std::string::npos ) {
+        return {};
+    }
+    const auto e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+// splits the line into two fields, the quotes are removed
+static std::vector<std::string> split(const std::string &line, char delimiter, std::size_t lineno) {
+    std::vector<std::string> res;
+    std::size_t i = 0;
+    while ( i <= line.size() ) {
+        std::string field;
+        while ( i < line.size() && (line[i] == ' ' || line[i] == '\t') ) {
+            ++i;
+        }
+        if ( i < line.size() && line[i] == '"' ) {
+            ++i;
+            for ( ;; ++i ) {
+                if ( i == line.size() ) {
+                    throw std::runtime_error("line " + std::to_string(lineno) + ": unterminated quote");
+                }
+                if ( line[i] == '"' ) {
+                    if ( i + 1 < line.size() && line[i + 1] == '"' ) {
+                        field += '"';
+                        ++i;
+                    } else {
+                        ++i;
+                        break;
+                    }
+                } else {
+                    field += line[i];
+                }
+            }
+            const auto next = line.find(delimiter, i);
+            if ( !trim(line.substr(i, next == std::string::npos ? std::string::npos : next - i)).empty() ) {
+                throw std::runtime_error("line " + std::to_string(lineno) + ": garbage after a quoted field");
+            }
+            i = (next == std::string::npos) ? line.size() + 1 : next + 1;
+        } else {
+            const auto next = line.find(delimiter, i);
+            field = trim(line.substr(i, next == std::string::npos ? std::string::npos : next - i));
+            i = (next == std::string::npos) ? line.size() + 1 : next + 1;
+        }
+        res.push_back(std::move(field));
+    }
+
+    return res;
+}
+
+static std::string quote(const std::string &s) {
+    static const char digits[] = "01234567";
+    std::string res = "\"";
+    bool has_nul = false;
+    for ( const char c: s ) {
+        switch ( c ) {
+            case '"' : res += "\\\""; break;
+            case '\\': res += "\\\\"; break;
+            case '\n': res += "\\n"; break;
+            case '\t': res += "\\t"; break;
+            case '\r': res += "\\r"; break;
+            default:
+                if ( static_cast<unsigned char>(c) < 0x20 || static_cast<unsigned char>(c) == 0x7f ) {
+                    // the octal escapes are always three digits, so the next char can't be absorbed
+                    const auto u = static_cast<unsigned char>(c);
+                    has_nul = has_nul || u == 0;
+                    res += '\\';
+                    res += digits[(u >> 6) & 7];
+                    res += digits[(u >> 3) & 7];
+                    res += digits[u & 7];
+                } else {
+                    res += c;
+                }
+        }
+    }
+    res += '"';
+    if ( has_nul ) {
+        res = "std::string_view{" + res + ", " + std::to_string(s.size()) + "}";
+    }
+
+    return res;
+}
+
+static void parse_number(entry &e) {
+    const char *p = e.key.c_str();
+    char *end = nullptr;
+    errno = 0;
+    e.negative = (*p == '-');
+    if ( e.negative ) {
+        e.bits = static_cast<std::uint64_t>(std::strtoll(p, &end, 0));
+    } else {
+        e.bits = std::strtoull(p, &end, 0);
+    }
+    if ( errno != 0 || end == p || *end != '\0' ) {
+        throw std::runtime_error("line " + std::to_string(e.line) + ": bad numeric key \"" + e.key + "\"");
+    }
+}
+
+static bool less_number(const entry &l, const entry &r) {
+    if ( l.negative != r.negative ) {
+        return l.negative;
+    }
+    return l.negative
+        ? static_cast<std::int64_t>(l.bits) < static_cast<std::int64_t>(r.bits)
+        : l.bits < r.bits
+    ;
+}
+
+/*************************************************************************************************/
+
+static options parse_options(int argc, char **argv) {
+    options o;
+    for ( int i = 1; i < argc; ++i ) {
+        const std::string arg = argv[i];
+        if ( i + 1 == argc ) {
+            throw std::runtime_error("no value for \"" + arg + "\"");
+        }
+        const std::string val = argv[++i];
+        if ( arg == "--input" ) {
+            o.input = val;
+        } else if ( arg == "--output" ) {
+            o.output = val;
+        } else if ( arg == "--name" ) {
+            o.name = val;
+        } else if ( arg == "--key-type" ) {
+            o.key_type = val;
+        } else if ( arg == "--value-type" ) {
+            o.value_type = val;
+        } else if ( arg == "--namespace" ) {
+            o.ns = val;
+        } else if ( arg == "--storage" ) {
+            o.storage = val;
+        } else if ( arg == "--delimiter" ) {
+            if ( val.size() != 1 ) {
+                throw std::runtime_error("the delimiter must be a single char");
+            }
+            o.delimiter = val[0];
+        } else {
+            throw std::runtime_error("unknown option \"" + arg + "\"");
+        }
+    }
+    if ( o.input.empty() || o.output.empty() || o.name.empty() || o.key_type.empty() || o.value_type.empty() ) {
+        throw std::runtime_error("--input, --output, --name, --key-type and --value-type are required");
+    }
+    if ( (o.storage == "string" || o.storage == "trie") && o.key_type != "string" ) {
+        throw std::runtime_error("the \"" + o.storage + "\" storage requires the string keys");
+    }
+
+    return o;
+}
+
+static std::string map_type(const options &o, const std::string &k, const std::string &v, std::size_t n) {
+    const std::string size = std::to_string(n);
+    if ( o.storage == "map" ) {
+        return "ctmap::map<" + size + ", " + k + ", " + v
+            + ", ctmap::details::less_key<std::pair<" + k + ", " + v + ">>>";
+    }
+    if ( o.storage == "unordered" || o.storage == "eytzinger" || o.storage == "soa" ) {
+        return "ctmap::" + o.storage + "_map<" + size + ", " + k + ", " + v + ">";
+    }
+    if ( o.storage == "string" || o.storage == "trie" ) {
+        return "ctmap::" + o.storage + "_map<" + size + ", " + v + ">";
+    }
+
+    throw std::runtime_error("unknown storage \"" + o.storage + "\"");
+}
+
+static void generate(const options &o) {
+    std::ifstream is{o.input};
+    if ( !is ) {
+        throw std::runtime_error("can't open \"" + o.input + "\"");
+    }
+
+    const bool string_keys = (o.key_type == "string");
+    const bool string_values = (o.value_type == "string");
+    std::vector<entry> entries;
+    std::string line;
+    for ( std::size_t lineno = 1; std::getline(is, line); ++lineno ) {
+        if ( trim(line).empty() || trim(line)[0] == '#' ) {
+            continue;
+        }
+        auto fields = split(line, o.delimiter, lineno);
+        if ( fields.size() != 2 ) {
+            throw std::runtime_error("line " + std::to_string(lineno) + ": expected two fields");
+        }
+        entry e{std::move(fields[0]), std::move(fields[1]), lineno, false, 0};
+        if ( !string_keys ) {
+            parse_number(e);
+        }
+        if ( !string_values && e.value.empty() ) {
+            throw std::runtime_error("line " + std::to_string(lineno) + ": empty value");
+        }
+        entries.push_back(std::move(e));
+    }
+
+    // the same order as `ctmap::details::less_key`, the strings are compared as the unsigned chars
+    const auto less = [string_keys](const entry &l, const entry &r)
+    { return string_keys ? l.key < r.key : less_number(l, r); };
+    std::stable_sort(entries.begin(), entries.end(), less);
+    for ( std::size_t i = 1; i < entries.size(); ++i ) {
+        if ( !less(entries[i - 1], entries[i]) ) {
+            throw std::runtime_error("line " + std::to_string(entries[i].line)
+                + ": duplicate key \"" + entries[i].key + "\", first seen at line "
+                + std::to_string(entries[i - 1].line));
+        }
+    }
+
+    const std::string k = string_keys ? "std::string_view" : o.key_type;
+    const std::string v = string_values ? "std::string_view" : o.value_type;
+    std::string guard = "__CTMAP_GEN__" + o.ns + "__" + o.name + "_HPP";
+    for ( auto &c: guard ) {
+        c = (std::isalnum(static_cast<unsigned char>(c)) || c == '_')
+            ? static_cast<char>(std::toupper(static_cast<unsigned char>(c)))
+            : '_'
+        ;
+    }
+
+    std::ostringstream os;
+    os << "// generated by ctmap-gen from \"" << o.input << "\", do not edit.\n\n"
+       << "#ifndef " << guard << "\n"
+       << "#define " << guard << "\n\n"
+       << "#include <ctmap/ctmap.hpp>\n\n"
+       << "#include <array>\n"
+       << "#include <cstdint>\n"
+       << "#include <string_view>\n"
+       << "#include <utility>\n\n";
+    if ( !o.ns.empty() ) {
+        os << "namespace " << o.ns << " {\n\n";
+    }
+    os << "inline constexpr std::array<std::pair<" << k << ", " << v << ">, " << entries.size()
+       << "> " << o.name << "_data = {{\n";
+    for ( std::size_t i = 0; i < entries.size(); ++i ) {
+        const auto &e = entries[i];
+        os << (i ? "    ,{" : "     {") << (string_keys ? quote(e.key) : e.key)
+           << ", " << (string_values ? quote(e.value) : e.value) << "}\n";
+    }
+    os << "}};\n\n"
+       << "inline constexpr " << map_type(o, k, v, entries.size())
+       << " " << o.name << "{ctmap::presorted, " << o.name << "_data};\n\n";
+    if ( !o.ns.empty() ) {
+        os << "} // ns " << o.ns << "\n\n";
+    }
+    os << "#endif // " << guard << "\n";
+
+    // the header is rewritten only when it changes, so the dependents are not rebuilt
+    const std::string text = os.str();
+    {
+        std::ifstream old{o.output, std::ios::binary};
+        std::ostringstream buf;
+        buf << old.rdbuf();
+        if ( old && buf.str() == text ) {
+            return;
+        }
+    }
+    std::ofstream out{o.output, std::ios::binary | std::ios::trunc};
+    out << text;
+    if ( !out ) {
+        throw std::runtime_error("can't write \"" + o.output + "\"");
+    }
+}
+
+/*************************************************************************************************/
+
+int main(int argc, char **argv) {
+    try {
+        generate(parse_options(argc, argv));
+    } catch (const std::exception &ex) {
+        std::cerr << "ctmap-gen: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*************************************************************************************************/